@@ -0,0 +1,774 @@
+#include <binary_stream.hpp>
+#include <parallel_serialization.hpp>
+#include <mapped_archive.hpp>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <list>
+#include <map>
+#include <new>
+#include <optional>
+#include <string>
+#include <vector>
+
+volatile size_t sink;
+
+size_t allocations = 0;
+
+void* operator new(size_t size) {
+    ++allocations;
+    if (auto ptr = std::malloc(size)) return ptr;
+    throw std::bad_alloc{};
+}
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+
+// Returns the mean number of allocations of one call.
+template <class F>
+double count_allocations(size_t iterations, F&& f) {
+    f();
+    auto const start = allocations;
+    for (size_t i = 0; i < iterations; ++i) f();
+    return static_cast<double>(allocations - start) / iterations;
+}
+
+// Returns the mean duration of one call, in nanoseconds.
+template <class F>
+double measure(size_t iterations, F&& f) {
+    f();
+    auto const start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) f();
+    auto const duration = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(duration).count() / iterations;
+}
+
+void report(char const* name, double reference_ns, double ns) {
+    printf("  %-24s %12.0f ns  (x%.2f)\n", name, ns, reference_ns / ns);
+}
+
+struct person {
+    std::string name;
+    int age;
+};
+
+std::vector<person> make_persons(size_t count) {
+    auto persons = std::vector<person>(count);
+    for (size_t i = 0; i < count; ++i) {
+        persons[i] = { "person #" + std::to_string(i), static_cast<int>(i % 100) };
+    }
+    return persons;
+}
+
+void bench_checked_deserialization() {
+    auto const persons = make_persons(10'000);
+    auto storage = std::vector<std::byte>(get_serialized_size(persons));
+    auto out = span<std::byte>{ storage };
+    serialize(persons, out);
+
+    auto const two_pass = measure(200, [&] {
+        auto in = span<std::byte const>{ storage };
+        auto result = std::vector<person>{};
+        auto const [_, success] = try_get_deserialized_size<std::vector<person>>(in);
+        if (success) deserialize(result, in);
+        sink = result.size();
+    });
+    auto const one_pass = measure(200, [&] {
+        auto in = span<std::byte const>{ storage };
+        auto result = std::vector<person>{};
+        try_deserialize(result, in);
+        sink = result.size();
+    });
+
+    printf("checked deserialization, 10k persons\n");
+    report("two passes", two_pass, two_pass);
+    report("single pass", two_pass, one_pass);
+}
+
+void bench_checked_serialization() {
+    auto strings = std::map<std::string, std::string>{};
+    for (int i = 0; i < 10'000; ++i) {
+        strings.emplace("key #" + std::to_string(i), "value #" + std::to_string(i));
+    }
+    auto storage = std::vector<std::byte>(get_serialized_size(strings));
+
+    auto const two_pass = measure(200, [&] {
+        auto out = span<std::byte>{ storage };
+        if (get_serialized_size(strings) <= out.size()) serialize(strings, out);
+        sink = out.size();
+    });
+    auto const one_pass = measure(200, [&] {
+        auto out = span<std::byte>{ storage };
+        try_serialize(strings, out);
+        sink = out.size();
+    });
+
+    printf("checked serialization, 10k strings map\n");
+    report("two passes", two_pass, two_pass);
+    report("single pass", two_pass, one_pass);
+}
+
+struct message {
+    std::vector<person> persons;
+    std::map<std::string, std::string> attributes;
+    std::list<std::string> tags;
+};
+
+void bench_reused_deserialization() {
+    auto msg = message{};
+    msg.persons = make_persons(100);
+    for (int i = 0; i < 100; ++i) {
+        msg.attributes.emplace("a rather long attribute key #" + std::to_string(i), "value #" + std::to_string(i));
+        msg.tags.push_back("a rather long tag name #" + std::to_string(i));
+    }
+    auto storage = std::vector<std::byte>(get_serialized_size(msg));
+    auto out = span<std::byte>{ storage };
+    serialize(msg, out);
+
+    auto const fresh = count_allocations(100, [&] {
+        auto in = span<std::byte const>{ storage };
+        auto result = message{};
+        deserialize(result, in);
+        sink = result.persons.size();
+    });
+    auto reused_object = message{};
+    auto const reused = count_allocations(100, [&] {
+        auto in = span<std::byte const>{ storage };
+        deserialize(reused_object, in);
+        sink = reused_object.persons.size();
+    });
+    // Checked reads decode into a new value, to leave the object untouched on failure.
+    auto const checked = count_allocations(100, [&] {
+        auto istream = binary_istream{ storage };
+        istream >> reused_object;
+        sink = reused_object.persons.size();
+    });
+
+    printf("allocations per message, 100 persons, attributes and tags\n");
+    printf("  %-24s %12.1f\n", "fresh object", fresh);
+    printf("  %-24s %12.1f\n", "reused object", reused);
+    printf("  %-24s %12.1f\n", "reused, checked stream", checked);
+}
+
+void bench_ordered_deserialization() {
+    auto map = std::map<uint64_t, uint64_t>{};
+    for (uint64_t i = 0; i < 1'000'000; ++i) map.emplace(i * 7, i);
+    auto storage = std::vector<std::byte>(get_serialized_size(map));
+    auto out = span<std::byte>{ storage };
+    serialize(map, out);
+
+    auto const unhinted = measure(5, [&] {
+        auto in = span<std::byte const>{ storage };
+        auto result = std::map<uint64_t, uint64_t>{};
+        auto count = size_t{};
+        deserialize(count, in);
+        for (size_t i = 0; i < count; ++i) {
+            auto element = std::pair<uint64_t, uint64_t>{};
+            deserialize(element, in);
+            result.emplace(element);
+        }
+        sink = result.size();
+    });
+    auto const hinted = measure(5, [&] {
+        auto in = span<std::byte const>{ storage };
+        auto result = std::map<uint64_t, uint64_t>{};
+        deserialize(result, in);
+        sink = result.size();
+    });
+
+    printf("ordered deserialization, 1M entries map\n");
+    report("emplace", unhinted, unhinted);
+    report("end hinted", unhinted, hinted);
+}
+
+struct sample {
+    std::string source;
+    uint32_t id;
+    uint32_t flags;
+    int64_t timestamp;
+    double value;
+    double error;
+};
+
+void bench_field_runs() {
+    auto samples = std::vector<sample>(10'000);
+    for (size_t i = 0; i < samples.size(); ++i) {
+        samples[i] = { "sensor", static_cast<uint32_t>(i), 0, static_cast<int64_t>(i) * 1000, i * 0.5, 0.01 };
+    }
+    auto storage = std::vector<std::byte>(get_serialized_size(samples));
+
+    auto const per_field = measure(500, [&] {
+        auto out = span<std::byte>{ storage };
+        for (auto& s : samples) serialize(as_tuple(s), out);
+        sink = out.size();
+    });
+    auto const runs = measure(500, [&] {
+        auto out = span<std::byte>{ storage };
+        for (auto& s : samples) serialize(s, out);
+        sink = out.size();
+    });
+    auto const per_field_read = measure(500, [&] {
+        auto in = span<std::byte const>{ storage };
+        for (auto& s : samples) {
+            auto fields = as_tuple(s);
+            deserialize(fields, in);
+        }
+        sink = in.size();
+    });
+    auto const runs_read = measure(500, [&] {
+        auto in = span<std::byte const>{ storage };
+        for (auto& s : samples) deserialize(s, in);
+        sink = in.size();
+    });
+
+    printf("aggregate field runs, 10k samples\n");
+    report("serialize per field", per_field, per_field);
+    report("serialize field runs", per_field, runs);
+    report("deserialize per field", per_field_read, per_field_read);
+    report("deserialize field runs", per_field_read, runs_read);
+}
+
+// Timestamps encoded by the delta codec, compared with the plain copy of std::vector<int64_t>.
+struct timestamps : std::vector<int64_t> {
+    using std::vector<int64_t>::vector;
+};
+template <>
+struct array_codec<timestamps> {
+    using type = delta_codec;
+};
+
+void bench_delta_codec() {
+    auto const count = size_t{ 1'000'000 };
+    auto plain   = std::vector<int64_t>(count);
+    auto encoded = timestamps(count);
+    for (size_t i = 0; i < count; ++i) {
+        plain[i] = encoded[i] = 1'600'000'000'000 + 1000 * static_cast<int64_t>(i) + static_cast<int64_t>(i * 7919 % 13);
+    }
+    auto plain_storage   = std::vector<std::byte>(get_serialized_size(plain));
+    auto encoded_storage = std::vector<std::byte>(get_serialized_size(encoded));
+
+    auto const copy = measure(50, [&] {
+        auto out = span<std::byte>{ plain_storage };
+        serialize(plain, out);
+        sink = out.size();
+    });
+    auto const encode = measure(50, [&] {
+        auto out = span<std::byte>{ encoded_storage };
+        serialize(encoded, out);
+        sink = out.size();
+    });
+    auto const copy_read = measure(50, [&] {
+        auto in = span<std::byte const>{ plain_storage };
+        deserialize(plain, in);
+        sink = plain.size();
+    });
+    auto const decode = measure(50, [&] {
+        auto in = span<std::byte const>{ encoded_storage };
+        deserialize(encoded, in);
+        sink = encoded.size();
+    });
+    auto const gb_per_s = [&] (double ns) { return count * sizeof(int64_t) / ns; };
+
+    printf("delta codec, 1M timestamps, %zu bytes instead of %zu\n", encoded_storage.size(), plain_storage.size());
+    report("serialize memcpy", copy, copy);
+    report("serialize delta", copy, encode);
+    report("deserialize memcpy", copy_read, copy_read);
+    report("deserialize delta", copy_read, decode);
+    printf("  %-24s %12.2f GB/s %8.2f GB/s\n", "memcpy, delta decode", gb_per_s(copy_read), gb_per_s(decode));
+}
+
+// Samples encoded by the xor codec, compared with the plain copy of std::vector<double>.
+struct series : std::vector<double> {
+    using std::vector<double>::vector;
+};
+template <>
+struct array_codec<series> {
+    using type = xor_codec;
+};
+
+void bench_xor_codec() {
+    auto const count = size_t{ 1'000'000 };
+    auto plain   = std::vector<double>(count);
+    auto encoded = series(count);
+    for (size_t i = 0; i < count; ++i) {
+        // A gauge sampled with a resolution of 0.25, changing every few samples.
+        plain[i] = encoded[i] = 20.0 + 0.25 * static_cast<double>((i / 4) * 7919 % 16);
+    }
+    auto plain_storage   = std::vector<std::byte>(get_serialized_size(plain));
+    auto encoded_storage = std::vector<std::byte>(get_serialized_size(encoded));
+
+    auto const copy = measure(50, [&] {
+        auto out = span<std::byte>{ plain_storage };
+        serialize(plain, out);
+        sink = out.size();
+    });
+    auto const encode = measure(50, [&] {
+        auto out = span<std::byte>{ encoded_storage };
+        serialize(encoded, out);
+        sink = out.size();
+    });
+    auto const copy_read = measure(50, [&] {
+        auto in = span<std::byte const>{ plain_storage };
+        deserialize(plain, in);
+        sink = plain.size();
+    });
+    auto const decode = measure(50, [&] {
+        auto in = span<std::byte const>{ encoded_storage };
+        deserialize(encoded, in);
+        sink = encoded.size();
+    });
+    auto const gb_per_s = [&] (double ns) { return count * sizeof(double) / ns; };
+
+    printf("xor codec, 1M samples, %zu bytes instead of %zu\n", encoded_storage.size(), plain_storage.size());
+    report("serialize memcpy", copy, copy);
+    report("serialize xor", copy, encode);
+    report("deserialize memcpy", copy_read, copy_read);
+    report("deserialize xor", copy_read, decode);
+    printf("  %-24s %12.2f GB/s %8.2f GB/s\n", "memcpy, xor decode", gb_per_s(copy_read), gb_per_s(decode));
+}
+
+void bench_compression() {
+    auto msg = message{};
+    msg.persons = make_persons(100'000);
+    for (int i = 0; i < 10'000; ++i) {
+        msg.attributes.emplace("a rather long attribute key #" + std::to_string(i), "value #" + std::to_string(i));
+        msg.tags.push_back("a rather long tag name #" + std::to_string(i));
+    }
+    auto pool = chunk_pool{};
+    auto plain = chunked_buffer{ pool };
+    auto compressed = chunked_buffer{ pool };
+
+    auto const copy = measure(20, [&] {
+        plain.clear();
+        serialize(msg, plain);
+        sink = plain.size();
+    });
+    auto const compress = measure(20, [&] {
+        compressed.clear();
+        auto ostream = compressed_ostream<chunked_buffer>{ compressed };
+        ostream << msg;
+        ostream.flush();
+        sink = compressed.size();
+    });
+    auto const plain_data = plain.to_vector();
+    auto const compressed_data = compressed.to_vector();
+    auto const copy_read = measure(20, [&] {
+        auto in = span<std::byte const>{ plain_data };
+        auto result = message{};
+        deserialize(result, in);
+        sink = result.persons.size();
+    });
+    auto const decompress = measure(20, [&] {
+        auto istream = compressed_istream{ compressed_data };
+        auto result = message{};
+        istream >> result;
+        sink = result.persons.size();
+    });
+
+    printf("block compression, 100k persons, %zu bytes instead of %zu\n", compressed_data.size(), plain_data.size());
+    report("serialize", copy, copy);
+    report("serialize compressed", copy, compress);
+    report("deserialize", copy_read, copy_read);
+    report("deserialize compressed", copy_read, decompress);
+}
+
+void bench_interning() {
+    using record = std::map<std::string, std::string>;
+    auto records = std::vector<record>(10'000);
+    char const* levels[] = { "debug", "info", "warning", "error" };
+    for (size_t i = 0; i < records.size(); ++i) {
+        records[i] = {
+            { "service",  "authentication-gateway" },
+            { "severity", levels[i % 4] },
+            { "host",     "host-" + std::to_string(i % 16) + ".internal.example.com" },
+            { "request",  std::to_string(i) },
+        };
+    }
+    auto storage = std::vector<std::byte>(get_serialized_size<compact_format>(records));
+    size_t plain_size = 0, interned_size = 0;
+
+    auto const plain = measure(50, [&] {
+        auto ostream = compact_binary_ostream{ storage };
+        ostream << records;
+        plain_size = ostream.data() - storage.data();
+    });
+    auto const interned = measure(50, [&] {
+        auto ostream = interning_ostream{ storage };
+        ostream << records;
+        interned_size = ostream.data() - storage.data();
+    });
+    auto const interned_read = measure(50, [&] {
+        auto istream = interning_istream{ storage.data(), interned_size };
+        auto result = std::vector<record>{};
+        istream >> result;
+        sink = result.size();
+    });
+    auto ostream = compact_binary_ostream{ storage };
+    ostream << records;
+    auto const plain_read = measure(50, [&] {
+        auto istream = compact_binary_istream{ storage.data(), plain_size };
+        auto result = std::vector<record>{};
+        istream >> result;
+        sink = result.size();
+    });
+
+    printf("string interning, 10k log records, %zu bytes instead of %zu\n", interned_size, plain_size);
+    report("serialize", plain, plain);
+    report("serialize interned", plain, interned);
+    report("deserialize", plain_read, plain_read);
+    report("deserialize interned", plain_read, interned_read);
+}
+
+size_t moves = 0;
+
+// Serialized as a string, counts its moves.
+struct tracked_string : std::string {
+    using std::string::string;
+    tracked_string() = default;
+    tracked_string(tracked_string const&) = default;
+    tracked_string(tracked_string&& rhs) noexcept : std::string{ std::move(rhs) } { ++moves; }
+    tracked_string& operator=(tracked_string const&) = default;
+    tracked_string& operator=(tracked_string&& rhs) noexcept {
+        ++moves;
+        std::string::operator=(std::move(rhs));
+        return *this;
+    }
+};
+
+void bench_in_place_deserialization() {
+    auto map = std::map<tracked_string, tracked_string>{};
+    for (int i = 0; i < 10'000; ++i) {
+        auto const key   = "a rather long key #"   + std::to_string(i);
+        auto const value = "a rather long value #" + std::to_string(i);
+        map.emplace(tracked_string(key.data(), key.size()), tracked_string(value.data(), value.size()));
+    }
+    auto storage = std::vector<std::byte>(get_serialized_size(map));
+    auto out = span<std::byte>{ storage };
+    serialize(map, out);
+
+    auto const temporary = [&] {
+        auto in = span<std::byte const>{ storage };
+        auto result = std::map<tracked_string, tracked_string>{};
+        auto count = size_t{};
+        deserialize(count, in);
+        for (size_t i = 0; i < count; ++i) {
+            auto element = std::pair<tracked_string, tracked_string>{};
+            deserialize(element, in);
+            result.emplace_hint(result.end(), std::move(element));
+        }
+        sink = result.size();
+    };
+    auto const in_place = [&] {
+        auto in = span<std::byte const>{ storage };
+        auto const result = deserialize<std::map<tracked_string, tracked_string>>(in);
+        sink = result.size();
+    };
+    auto const count_moves = [&] (auto&& f) {
+        moves = 0;
+        f();
+        return static_cast<double>(moves) / map.size();
+    };
+
+    auto const temporary_ns = measure(50, temporary);
+    auto const in_place_ns  = measure(50, in_place);
+
+    printf("in place deserialization, 10k strings map\n");
+    report("temporary then move", temporary_ns, temporary_ns);
+    report("in place", temporary_ns, in_place_ns);
+    printf("  %-24s %12.1f moves/entry %8.0f allocations\n", "temporary then move",
+        count_moves(temporary), count_allocations(10, temporary));
+    printf("  %-24s %12.1f moves/entry %8.0f allocations\n", "in place",
+        count_moves(in_place), count_allocations(10, in_place));
+}
+
+// State synchronization messages, with their flags and enums stored in bytes or bit packed.
+enum class unit_order : uint8_t { hold, move, attack, patrol, retreat };
+
+template <>
+struct value_range<unit_order> {
+    static constexpr auto min = unit_order::hold;
+    static constexpr auto max = unit_order::retreat;
+};
+
+struct unit_bytes {
+    uint32_t id;
+    bool alive, visible, selected;
+    uint8_t order;
+    int8_t heading;
+};
+
+struct unit_bits {
+    uint32_t id;
+    packed_bool alive, visible, selected;
+    unit_order order;
+    ranged<int8_t, -64, 63> heading;
+};
+
+void bench_bit_packing() {
+    auto const count = size_t{ 100'000 };
+    auto bytes = std::vector<unit_bytes>(count);
+    auto bits  = std::vector<unit_bits>(count);
+    for (size_t i = 0; i < count; ++i) {
+        auto const order   = static_cast<uint8_t>(i % 5);
+        auto const heading = static_cast<int8_t>(static_cast<int>(i % 128) - 64);
+        bytes[i] = { static_cast<uint32_t>(i), i % 7 != 0, i % 3 == 0, i % 11 == 0, order, heading };
+        bits[i]  = { static_cast<uint32_t>(i), i % 7 != 0, i % 3 == 0, i % 11 == 0, static_cast<unit_order>(order), heading };
+    }
+    auto storage = std::vector<std::byte>(get_serialized_size(bytes));
+
+    auto const plain = measure(100, [&] {
+        auto out = span<std::byte>{ storage };
+        for (auto& unit : bytes) serialize(unit, out);
+        sink = out.size();
+    });
+    auto const packed = measure(100, [&] {
+        auto out = span<std::byte>{ storage };
+        for (auto& unit : bits) serialize(unit, out);
+        sink = out.size();
+    });
+    auto const plain_read = measure(100, [&] {
+        auto in = span<std::byte const>{ storage };
+        for (auto& unit : bytes) deserialize(unit, in);
+        sink = in.size();
+    });
+    auto const packed_read = measure(100, [&] {
+        auto in = span<std::byte const>{ storage };
+        for (auto& unit : bits) deserialize(unit, in);
+        sink = in.size();
+    });
+
+    printf("bit packing, 100k units, %zu bytes instead of %zu\n",
+        count * serialized_size_v<unit_bits>, count * serialized_size_v<unit_bytes>);
+    report("serialize bytes", plain, plain);
+    report("serialize bit packed", plain, packed);
+    report("deserialize bytes", plain_read, plain_read);
+    report("deserialize bit packed", plain_read, packed_read);
+}
+
+// Sparse records, compared with the copy of their full storage.
+struct sparse_record {
+    uint32_t id;
+    std::optional<int32_t> quantity, discount, priority;
+    std::optional<double> price, weight;
+};
+
+void bench_optionals() {
+    auto records = std::vector<sparse_record>(100'000);
+    for (size_t i = 0; i < records.size(); ++i) {
+        auto& record = records[i];
+        record.id = static_cast<uint32_t>(i);
+        if (i % 10 == 0) record.quantity = static_cast<int32_t>(i % 100);
+        if (i % 25 == 0) record.price = i * 0.25;
+    }
+    auto const full_size = records.size() * sizeof(sparse_record);
+    auto storage = std::vector<std::byte>(full_size);
+
+    auto const copy = measure(100, [&] {
+        memcpy(storage.data(), records.data(), full_size);
+        sink = storage.size();
+    });
+    auto const tagged = measure(100, [&] {
+        auto out = span<std::byte>{ storage };
+        serialize(records, out);
+        sink = out.size();
+    });
+    auto const tagged_read = measure(100, [&] {
+        auto in = span<std::byte const>{ storage };
+        auto result = std::vector<sparse_record>{};
+        deserialize(result, in);
+        sink = result.size();
+    });
+
+    printf("optional fields, 100k sparse records, %zu bytes instead of %zu\n", get_serialized_size(records), full_size);
+    report("copy full storage", copy, copy);
+    report("serialize tagged", copy, tagged);
+    report("deserialize tagged", copy, tagged_read);
+}
+
+struct big_endian_format : portable_format {
+    static constexpr auto endianness = byte_order::big;
+};
+
+void bench_byte_orders() {
+    auto values = std::vector<uint32_t>(1'000'000);
+    for (size_t i = 0; i < values.size(); ++i) values[i] = static_cast<uint32_t>(i * 2654435761u);
+    auto storage = std::vector<std::byte>(get_serialized_size<portable_format>(values));
+
+    auto const copy = measure(100, [&] {
+        memcpy(storage.data() + 8, values.data(), values.size() * sizeof(uint32_t));
+        sink = storage.size();
+    });
+    auto const portable = measure(100, [&] {
+        auto out = span<std::byte>{ storage };
+        serialize<portable_format>(values, out);
+        sink = out.size();
+    });
+    auto const swapped = measure(100, [&] {
+        auto out = span<std::byte>{ storage };
+        serialize<big_endian_format>(values, out);
+        sink = out.size();
+    });
+    auto const swapped_read = measure(100, [&] {
+        auto in = span<std::byte const>{ storage };
+        deserialize<big_endian_format>(values, in);
+        sink = values.size();
+    });
+
+    printf("byte orders, 1M uint32_t\n");
+    report("copy", copy, copy);
+    report("serialize host order", copy, portable);
+    report("serialize swapped", copy, swapped);
+    report("deserialize swapped", copy, swapped_read);
+}
+
+void bench_parallel_serialization() {
+    auto const persons = make_persons(1'000'000);
+    auto storage = std::vector<std::byte>(get_serialized_size(persons));
+    auto pool = thread_pool{};
+
+    auto const sequential = measure(20, [&] {
+        auto out = span<std::byte>{ storage };
+        serialize(persons, out);
+        sink = out.size();
+    });
+    auto const parallel = measure(20, [&] {
+        auto out = span<std::byte>{ storage };
+        parallel_serialize(persons, out, pool);
+        sink = out.size();
+    });
+
+    printf("parallel serialization, 1M persons, %zu threads\n", pool.size());
+    report("serialize", sequential, sequential);
+    report("parallel serialize", sequential, parallel);
+}
+
+void bench_parallel_deserialization() {
+    auto const persons = make_persons(1'000'000);
+    auto storage = std::vector<std::byte>(get_serialized_size<indexed_format>(persons));
+    auto out = span<std::byte>{ storage };
+    serialize<indexed_format>(persons, out);
+    auto pool = thread_pool{};
+
+    auto const sequential = measure(20, [&] {
+        auto in = span<std::byte const>{ storage };
+        auto result = std::vector<person>{};
+        try_deserialize<indexed_format>(result, in);
+        sink = result.size();
+    });
+    auto const parallel = measure(20, [&] {
+        auto in = span<std::byte const>{ storage };
+        auto result = std::vector<person>{};
+        parallel_deserialize<indexed_format>(result, in, pool);
+        sink = result.size();
+    });
+
+    printf("parallel deserialization, 1M persons, index of %zu bytes, %zu threads\n",
+        storage.size() - get_serialized_size(persons), pool.size());
+    report("deserialize", sequential, sequential);
+    report("parallel deserialize", sequential, parallel);
+}
+
+struct record {
+    uint64_t id;
+    std::string title;
+    std::vector<person> persons;
+    std::map<std::string, std::string> attributes;
+    uint32_t revision;
+};
+
+struct byte_vector {
+    std::vector<std::byte> bytes;
+
+    void write(void const* data, size_t size) {
+        auto const begin = static_cast<std::byte const*>(data);
+        bytes.insert(bytes.end(), begin, begin + size);
+    }
+};
+
+void bench_lazy_reader() {
+    auto value = record{ 42, "quarterly report", make_persons(8000), {}, 7 };
+    for (int i = 0; i < 100; ++i) value.attributes["key #" + std::to_string(i)] = std::string(40, 'v');
+    auto archive = byte_vector{};
+    serialize_with_tables(value, archive);
+
+    auto const full = measure(200, [&] {
+        auto in = span<std::byte const>{ archive.bytes };
+        auto result = record{};
+        try_deserialize(result, in);
+        sink = result.id + result.revision + result.persons[5000].name.size();
+    });
+    auto const lazy = measure(200, [&] {
+        auto const reader = lazy_reader<record>{ archive.bytes };
+        auto id = uint64_t{};
+        auto revision = uint32_t{};
+        auto name = std::string{};
+        reader.get<0>().try_read(id);
+        reader.get<4>().try_read(revision);
+        reader.get<2>()[5000].get<0>().try_read(name);
+        sink = id + revision + name.size();
+    });
+
+    printf("lazy reader, record of %zu bytes with %zu bytes of tables, 3 fields read\n",
+        get_serialized_size(value), archive.bytes.size() - get_serialized_size(value));
+    report("deserialize", full, full);
+    report("lazy reader", full, lazy);
+}
+
+void bench_mapped_archive() {
+    auto const path = "bench_archive.bin";
+    auto const persons = make_persons(500);
+    size_t file_size = 0;
+    {
+        auto writer = archive_writer{ path };
+        for (int i = 0; i < 4000; ++i) writer.write(persons);
+        writer.close();
+    }
+    // Reads the whole file, then the directory entry and the record.
+    auto const loaded = measure(10, [&] {
+        auto const file = std::fopen(path, "rb");
+        std::fseek(file, 0, SEEK_END);
+        file_size = static_cast<size_t>(std::ftell(file));
+        std::fseek(file, 0, SEEK_SET);
+        auto data = std::vector<std::byte>(file_size);
+        sink = std::fread(data.data(), 1, data.size(), file);
+        std::fclose(file);
+
+        auto entry = span<std::byte const>{ data.data() + data.size() - 2 * sizeof(uint64_t), 2 * sizeof(uint64_t) };
+        auto bounds = std::pair<uint64_t, uint64_t>{};
+        deserialize<portable_format>(bounds, entry);
+        auto in = span<std::byte const>{ data.data() + bounds.first, static_cast<size_t>(bounds.second) };
+        auto result = std::vector<person>{};
+        try_deserialize(result, in);
+        sink = result.size();
+    });
+    auto const mapped = measure(10, [&] {
+        auto const archive = mapped_archive{ path };
+        auto result = std::vector<person>{};
+        archive.try_read(archive.size() - 1, result);
+        sink = result.size();
+    });
+    std::remove(path);
+
+    printf("mapped archive, 4000 records in %zu bytes, last record read\n", file_size);
+    report("read file", loaded, loaded);
+    report("mapped archive", loaded, mapped);
+}
+
+int main() {
+    bench_checked_deserialization();
+    bench_checked_serialization();
+    bench_reused_deserialization();
+    bench_ordered_deserialization();
+    bench_in_place_deserialization();
+    bench_field_runs();
+    bench_delta_codec();
+    bench_xor_codec();
+    bench_compression();
+    bench_interning();
+    bench_bit_packing();
+    bench_optionals();
+    bench_byte_orders();
+    bench_parallel_serialization();
+    bench_parallel_deserialization();
+    bench_lazy_reader();
+    bench_mapped_archive();
+}
@@ -2,6 +2,7 @@
 #pragma once
 
 #include <utility.hpp>
+#include <array>
 
 namespace detail {
 
@@ -105,7 +106,7 @@ namespace detail {
 
     // Computes the number of elements in the aggregate.
 
-    template <class T, size_t N>
+    template <class T, size_t N, bool Constructible = false>
     constexpr int get_airity() {
 
         static_assert(N <= max_arity + 1,
@@ -113,9 +114,16 @@ namespace detail {
             "You can increase the number of these functions by hand.");
 
         if constexpr (is_brace_constructible_v<T, N>) {
-            return get_airity<T, N + 1>();
+            return get_airity<T, N + 1, true>();
+        }
+        else if constexpr (Constructible) {
+            return static_cast<int>(N) - 1;
         }
-        else return static_cast<int>(N) - 1;
+        // Elements which can't be default constructed must be given.
+        else if constexpr (N <= max_arity) {
+            return get_airity<T, N + 1, false>();
+        }
+        else return -1;
     }
 
 } // ::detail
@@ -154,5 +162,30 @@ constexpr auto to_tuple(T && aggregate) noexcept {
 template <class Aggregate>
 using to_tuple_t = decltype(to_tuple(std::declval<Aggregate&&>()));
 
+// Types of the N first fields of an aggregate, without references nor const.
+template <class T, size_t N = airity_v<T>>
+using field_types_t = map_tuple_types_t<decltype(detail::as_tuple_impl(
+    std::declval<T&>(), std::integral_constant<int, static_cast<int>(N)>{})), remove_cvref>;
+
+namespace detail {
+    constexpr size_t align_up(size_t offset, size_t alignment) noexcept {
+        return (offset + alignment - 1) / alignment * alignment;
+    }
 
+    template <class T, size_t...Is>
+    constexpr auto get_field_offsets(std::index_sequence<Is...>) noexcept {
+        using fields = field_types_t<T, sizeof...(Is)>;
+        auto offsets = std::array<size_t, sizeof...(Is)>{};
+        size_t end = 0;
+        ((offsets[Is] = align_up(end, alignof(std::tuple_element_t<Is, fields>)),
+          end = offsets[Is] + sizeof(std::tuple_element_t<Is, fields>)), ...);
+        return offsets;
+    }
+}
 
+// Offsets of the fields of a standard layout aggregate, following the layout rules :
+// each field is placed at the first offset aligned for its type, after the previous one.
+// Fields declared with alignas are not accounted for : the offsets must be checked against
+// the addresses of the fields of a value.
+template <class T, size_t N = airity_v<T>>
+constexpr auto field_offsets_v = detail::get_field_offsets<T>(std::make_index_sequence<N>{});
@@ -2,6 +2,10 @@
 #pragma once
 
 #include <serialization.hpp>
+#include <chunked_buffer.hpp>
+#include <buffer_sequence.hpp>
+#include <compressed_buffer.hpp>
+#include <string_dictionary.hpp>
 
 namespace detail {
     template <class StreamDerived, class SpanBase, class ErrorPolicy>
@@ -19,29 +23,34 @@ namespace detail {
     struct ostream_mixin : stream_mixin_base<StreamDerived, SpanBase, ErrorPolicy> {};
 }
 
-template <class ErrorPolicy>
+template <class ErrorPolicy, class Format = native_format>
 struct basic_binary_istream :
     span<std::byte const>,
-    detail::istream_mixin<basic_binary_istream<ErrorPolicy>, span<const std::byte>, ErrorPolicy>
+    detail::istream_mixin<basic_binary_istream<ErrorPolicy, Format>, span<const std::byte>, ErrorPolicy>
 {
+    using format = Format;
     using span::span;
 };
-template <class ErrorPolicy>
+template <class ErrorPolicy, class Format = native_format>
 struct basic_binary_ostream :
     span<std::byte>,
-    detail::ostream_mixin<basic_binary_ostream<ErrorPolicy>, span<std::byte>, ErrorPolicy>
+    detail::ostream_mixin<basic_binary_ostream<ErrorPolicy, Format>, span<std::byte>, ErrorPolicy>
 {
+    using format = Format;
     using span::span;
 };
-template <class ErrorPolicy>
+template <class ErrorPolicy, class Format = native_format>
 struct basic_binary_stream :
     span<std::byte>,
-    detail::istream_mixin<basic_binary_stream<ErrorPolicy>, span<std::byte>, ErrorPolicy>,
-    detail::ostream_mixin<basic_binary_stream<ErrorPolicy>, span<std::byte>, ErrorPolicy>
+    detail::istream_mixin<basic_binary_stream<ErrorPolicy, Format>, span<std::byte>, ErrorPolicy>,
+    detail::ostream_mixin<basic_binary_stream<ErrorPolicy, Format>, span<std::byte>, ErrorPolicy>
 {
+    using format = Format;
     using span::span;
 };
 
+// Streams which check their reads leave the value untouched when they fail, and so don't reuse
+// its storage. Unchecked streams deserialize into the storage of the value.
 struct unchecked_serialization_policy {};
 struct throwing_serialization_policy  {};
 struct fail_flag_serialization_policy { bool overflow = false; };
@@ -58,54 +67,132 @@ using binary_istream = basic_binary_istream<fail_flag_serialization_policy>;
 using binary_ostream = basic_binary_ostream<fail_flag_serialization_policy>;
 using binary_stream  = basic_binary_stream<fail_flag_serialization_policy>;
 
+using compact_binary_istream = basic_binary_istream<fail_flag_serialization_policy, compact_format>;
+using compact_binary_ostream = basic_binary_ostream<fail_flag_serialization_policy, compact_format>;
+using compact_binary_stream  = basic_binary_stream<fail_flag_serialization_policy, compact_format>;
+
+using portable_binary_istream = basic_binary_istream<fail_flag_serialization_policy, portable_format>;
+using portable_binary_ostream = basic_binary_ostream<fail_flag_serialization_policy, portable_format>;
+using portable_binary_stream  = basic_binary_stream<fail_flag_serialization_policy, portable_format>;
+
+// Streams over a contiguous buffer which write repeated strings once, with an interned format.
+template <class ErrorPolicy, class Format = interned_format>
+struct basic_interning_istream :
+    interning_span<std::byte const>,
+    detail::istream_mixin<basic_interning_istream<ErrorPolicy, Format>, interning_span<std::byte const>, ErrorPolicy>
+{
+    using format = Format;
+    using interning_span::interning_span;
+};
+template <class ErrorPolicy, class Format = interned_format>
+struct basic_interning_ostream :
+    interning_span<std::byte>,
+    detail::ostream_mixin<basic_interning_ostream<ErrorPolicy, Format>, interning_span<std::byte>, ErrorPolicy>
+{
+    using format = Format;
+    using interning_span::interning_span;
+};
+
+using interning_istream = basic_interning_istream<fail_flag_serialization_policy>;
+using interning_ostream = basic_interning_ostream<fail_flag_serialization_policy>;
+
+// Growable ostream, which never overflows.
+template <class Format = native_format>
+struct basic_chunked_ostream :
+    chunked_buffer,
+    detail::ostream_mixin<basic_chunked_ostream<Format>, chunked_buffer, unchecked_serialization_policy>
+{
+    using format = Format;
+    using chunked_buffer::chunked_buffer;
+};
+
+using chunked_ostream         = basic_chunked_ostream<>;
+using compact_chunked_ostream = basic_chunked_ostream<compact_format>;
+
+// Istream over a sequence of non-contiguous buffers.
+template <class ErrorPolicy, class Format = native_format>
+struct basic_buffer_sequence_istream :
+    buffer_sequence_reader,
+    detail::istream_mixin<basic_buffer_sequence_istream<ErrorPolicy, Format>, buffer_sequence_reader, ErrorPolicy>
+{
+    using format = Format;
+    using buffer_sequence_reader::buffer_sequence_reader;
+};
+
+using buffer_sequence_istream         = basic_buffer_sequence_istream<fail_flag_serialization_policy>;
+using compact_buffer_sequence_istream = basic_buffer_sequence_istream<fail_flag_serialization_policy, compact_format>;
+
+// Ostream compressing its output by blocks into a destination, which never overflows unless
+// the destination is a span. The last block is written by flush().
+template <class Destination, class Format = native_format>
+struct basic_compressed_ostream :
+    compressing_writer<Destination>,
+    detail::ostream_mixin<basic_compressed_ostream<Destination, Format>, compressing_writer<Destination>, unchecked_serialization_policy>
+{
+    using format = Format;
+    using compressing_writer<Destination>::compressing_writer;
+};
+
+template <class Destination>
+using compressed_ostream         = basic_compressed_ostream<Destination>;
+template <class Destination>
+using compact_compressed_ostream = basic_compressed_ostream<Destination, compact_format>;
+
+// Istream decompressing a compressed stream block by block.
+template <class ErrorPolicy, class Format = native_format>
+struct basic_compressed_istream :
+    decompressing_reader,
+    detail::istream_mixin<basic_compressed_istream<ErrorPolicy, Format>, decompressing_reader, ErrorPolicy>
+{
+    using format = Format;
+    using decompressing_reader::decompressing_reader;
+};
+
+using compressed_istream         = basic_compressed_istream<fail_flag_serialization_policy>;
+using compact_compressed_istream = basic_compressed_istream<fail_flag_serialization_policy, compact_format>;
+
 namespace detail {
     template <class T, class StreamDerived, class SpanBase>
     StreamDerived& operator<<(ostream_mixin<StreamDerived, SpanBase, unchecked_serialization_policy>& stream, T const& value) {
-        serialize(value, stream.span());
+        serialize<typename StreamDerived::format>(value, stream.span());
         return stream.base();
     }
     template <class T, class StreamDerived, class SpanBase>
     StreamDerived& operator<<(ostream_mixin<StreamDerived, SpanBase, throwing_serialization_policy>& stream, T const& value) {
-        auto const size = get_serialized_size(value);
-        if (size > stream.span().size()) throw std::runtime_error{"Tried to overflow binary ostream"};
-        serialize(value, stream.span());
+        if (!try_serialize<typename StreamDerived::format>(value, stream.span())) {
+            throw std::runtime_error{"Tried to overflow binary ostream"};
+        }
         return stream.base();
     }
     template <class T, class StreamDerived, class SpanBase>
     StreamDerived& operator<<(ostream_mixin<StreamDerived, SpanBase, fail_flag_serialization_policy>& stream, T const& value) {
         if (stream.overflow) return stream.base();
 
-        auto const size = get_serialized_size(value);
-        if (size > stream.span().size()) {
+        if (!try_serialize<typename StreamDerived::format>(value, stream.span())) {
             stream.overflow = true;
-            return stream.base();
         }
-        serialize(value, stream.span());
         return stream.base();
     }
     
     template <class T, class StreamDerived, class SpanBase>
     StreamDerived& operator>>(istream_mixin<StreamDerived, SpanBase, unchecked_serialization_policy>& stream, T& value) {
-        deserialize(value, stream.span());
+        deserialize<typename StreamDerived::format>(value, stream.span());
         return stream.base();
     }
     template <class T, class StreamDerived, class SpanBase>
     StreamDerived& operator>>(istream_mixin<StreamDerived, SpanBase, throwing_serialization_policy>& stream, T& value) {
-        auto const [_, success] = try_get_deserialized_size<T>(stream.span());
-        if (!success) throw std::runtime_error{"Tried to overflow binary istream"};
-        deserialize(value, stream.span());
+        if (!try_deserialize<typename StreamDerived::format>(value, stream.span())) {
+            throw std::runtime_error{"Tried to overflow binary istream"};
+        }
         return stream.base();
     }
     template <class T, class StreamDerived, class SpanBase>
     StreamDerived& operator>>(istream_mixin<StreamDerived, SpanBase, fail_flag_serialization_policy>& stream, T& value) {
         if (stream.overflow) return stream.base();
 
-        auto const [_, success] = try_get_deserialized_size<T>(stream.span());
-        if (!success) {
+        if (!try_deserialize<typename StreamDerived::format>(value, stream.span())) {
             stream.overflow = true;
-            return stream.base();
         }
-        deserialize(value, stream.span());
         return stream.base();
     }
 }
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <span.hpp>
+#include <cstdint>
+#include <cstring>
+
+// Input source reading a sequence of non-contiguous buffers as one.
+// It only references the buffers and their list, which must outlive it.
+class buffer_sequence_reader {
+    span<std::byte const> const* next_;
+    span<std::byte const> const* last_;
+    std::byte const* begin_ = nullptr;
+    std::byte const* end_   = nullptr;
+    size_t size_ = 0;
+
+    void next_buffer() noexcept {
+        while (begin_ == end_ && next_ != last_) {
+            begin_ = next_->begin();
+            end_   = next_->end();
+            ++next_;
+        }
+    }
+public:
+    buffer_sequence_reader(span<span<std::byte const> const> buffers) noexcept :
+        next_{ buffers.begin() },
+        last_{ buffers.end() }
+    {
+        for (auto& buffer : buffers) size_ += buffer.size();
+        next_buffer();
+    }
+
+    // Remaining number of bytes.
+    size_t size() const noexcept { return size_; }
+
+    void read(void* data, size_t size) noexcept {
+        assert(size <= size_);
+        auto bytes = static_cast<std::byte*>(data);
+        size_ -= size;
+
+        auto available = static_cast<size_t>(end_ - begin_);
+        while (size > available) {
+            if (available > 0) memcpy(bytes, begin_, available);
+            bytes += available;
+            size  -= available;
+            begin_ = end_;
+            next_buffer();
+            available = static_cast<size_t>(end_ - begin_);
+        }
+        if (size > 0) {
+            memcpy(bytes, begin_, size);
+            begin_ += size;
+        }
+        next_buffer();
+    }
+
+    // Returns a pointer to the next bytes if they are contiguous and aligned, nullptr otherwise.
+    std::byte const* read_view(size_t size, size_t alignment) noexcept {
+        auto const data = begin_;
+        if (static_cast<size_t>(end_ - begin_) < size) return nullptr;
+        if (reinterpret_cast<uintptr_t>(data) % alignment != 0) return nullptr;
+        begin_ += size;
+        size_  -= size;
+        next_buffer();
+        return data;
+    }
+};
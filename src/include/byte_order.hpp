@@ -0,0 +1,102 @@
+#pragma once
+
+#include <format.hpp>
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define BYTE_ORDER_AVX2
+#endif
+#if defined(__SSSE3__) || defined(__AVX2__)
+#include <tmmintrin.h>
+#define BYTE_ORDER_SSSE3
+#endif
+
+// Mixed endian hosts are not supported.
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+constexpr auto host_byte_order = byte_order::big;
+#else
+constexpr auto host_byte_order = byte_order::little;
+#endif
+
+// Formats whose byte order differs from the host one, whose scalars are reversed.
+template <class Format>
+constexpr bool is_foreign_order_v = Format::endianness != byte_order::native && Format::endianness != host_byte_order;
+
+namespace detail::byte_swap {
+    inline uint16_t swap_word(uint16_t value) noexcept {
+        return static_cast<uint16_t>((value << 8) | (value >> 8));
+    }
+    inline uint32_t swap_word(uint32_t value) noexcept {
+#if defined(__GNUC__)
+        return __builtin_bswap32(value);
+#else
+        return (value << 24) | ((value << 8) & 0xFF0000u) | ((value >> 8) & 0xFF00u) | (value >> 24);
+#endif
+    }
+    inline uint64_t swap_word(uint64_t value) noexcept {
+#if defined(__GNUC__)
+        return __builtin_bswap64(value);
+#else
+        return (uint64_t{ swap_word(static_cast<uint32_t>(value)) } << 32) | swap_word(static_cast<uint32_t>(value >> 32));
+#endif
+    }
+
+    // Reverses the bytes of a scalar in place.
+    inline void swap_bytes(std::byte* data, size_t size) noexcept {
+        auto const swap = [data] (auto word) {
+            memcpy(&word, data, sizeof(word));
+            word = swap_word(word);
+            memcpy(data, &word, sizeof(word));
+        };
+        switch (size) {
+        case 2:  swap(uint16_t{}); break;
+        case 4:  swap(uint32_t{}); break;
+        case 8:  swap(uint64_t{}); break;
+        default: std::reverse(data, data + size);
+        }
+    }
+
+#ifdef BYTE_ORDER_SSSE3
+    // Shuffle reversing the bytes of each value of Size bytes, in 16 bytes lanes.
+    template <size_t Size>
+    constexpr auto shuffle_mask_v = [] {
+        auto mask = std::array<int8_t, 32>{};
+        for (size_t i = 0; i < mask.size(); ++i) mask[i] = static_cast<int8_t>(i % 16 / Size * Size + Size - 1 - i % Size);
+        return mask;
+    }();
+#endif
+
+    // Copies count values of Size bytes with their bytes reversed, 32 or 16 bytes at once with
+    // byte shuffles when available.
+    template <size_t Size>
+    void copy_swapped(std::byte* out, std::byte const* in, size_t count) noexcept {
+        // The pointers advance with the values, so that the scalar tail computes no offset
+        // from a count of values.
+        auto const end = in + count * Size;
+        if constexpr (Size == 2 || Size == 4 || Size == 8 || Size == 16) {
+#ifdef BYTE_ORDER_AVX2
+            auto const mask32 = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(shuffle_mask_v<Size>.data()));
+            for (; end - in >= 32; in += 32, out += 32) {
+                auto const v = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(in));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_shuffle_epi8(v, mask32));
+            }
+#endif
+#ifdef BYTE_ORDER_SSSE3
+            auto const mask16 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(shuffle_mask_v<Size>.data()));
+            for (; end - in >= 16; in += 16, out += 16) {
+                auto const v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(in));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_shuffle_epi8(v, mask16));
+            }
+#endif
+        }
+        for (; in != end; in += Size, out += Size) {
+            if (out != in) memcpy(out, in, Size);
+            swap_bytes(out, Size);
+        }
+    }
+}
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <span.hpp>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Recycles chunks of a fixed size between chunked buffers.
+// It is not thread-safe : use one pool per thread.
+class chunk_pool {
+    size_t chunk_size_;
+    std::vector<std::unique_ptr<std::byte[]>> free_chunks_;
+public:
+    explicit chunk_pool(size_t chunk_size = 64 * 1024) noexcept :
+        chunk_size_{ chunk_size }
+    {}
+
+    size_t chunk_size() const noexcept { return chunk_size_; }
+
+    std::unique_ptr<std::byte[]> acquire() {
+        if (free_chunks_.empty()) return std::unique_ptr<std::byte[]>{ new std::byte[chunk_size_] };
+        auto chunk = std::move(free_chunks_.back());
+        free_chunks_.pop_back();
+        return chunk;
+    }
+    void release(std::unique_ptr<std::byte[]> chunk) {
+        free_chunks_.push_back(std::move(chunk));
+    }
+};
+
+// Growable output buffer, made of a chain of chunks taken from a pool.
+// Writes bigger than a chunk are copied at once in a dedicated chunk.
+class chunked_buffer {
+    struct chunk {
+        std::unique_ptr<std::byte[]> data;
+        size_t size;
+        bool pooled;
+    };
+    chunk_pool* pool_;
+    std::vector<chunk> chunks_;
+    std::byte* begin_ = nullptr;
+    std::byte* end_   = nullptr;
+    size_t size_ = 0;
+
+    void close_chunk() noexcept {
+        if (chunks_.empty()) return;
+        auto& last = chunks_.back();
+        if (last.pooled) last.size = begin_ - last.data.get();
+    }
+    void push_chunk(std::unique_ptr<std::byte[]> data, size_t size, bool pooled) {
+        close_chunk();
+        chunks_.push_back({ std::move(data), size, pooled });
+        begin_ = chunks_.back().data.get();
+        end_   = begin_ + size;
+    }
+    template <class F>
+    void for_each_chunk(F&& f) const {
+        for (auto& c : chunks_) {
+            auto const size = (&c == &chunks_.back() && c.pooled)
+                ? static_cast<size_t>(begin_ - c.data.get())
+                : c.size;
+            if (size > 0) f(span<std::byte const>{ c.data.get(), size });
+        }
+    }
+public:
+    explicit chunked_buffer(chunk_pool& pool) noexcept :
+        pool_{ &pool }
+    {}
+    chunked_buffer(chunked_buffer&& rhs) noexcept :
+        pool_  { rhs.pool_ },
+        chunks_{ std::move(rhs.chunks_) },
+        begin_ { std::exchange(rhs.begin_, nullptr) },
+        end_   { std::exchange(rhs.end_,   nullptr) },
+        size_  { std::exchange(rhs.size_,  0) }
+    {}
+    chunked_buffer& operator=(chunked_buffer&& rhs) {
+        clear();
+        pool_   = rhs.pool_;
+        chunks_ = std::move(rhs.chunks_);
+        begin_  = std::exchange(rhs.begin_, nullptr);
+        end_    = std::exchange(rhs.end_,   nullptr);
+        size_   = std::exchange(rhs.size_,  0);
+        return *this;
+    }
+    ~chunked_buffer() { clear(); }
+
+    // Total number of bytes written.
+    size_t size() const noexcept { return size_; }
+
+    void write(void const* data, size_t size) {
+        if (size == 0) return;
+        auto bytes = static_cast<std::byte const*>(data);
+        size_ += size;
+
+        auto const available = static_cast<size_t>(end_ - begin_);
+        if (size <= available) {
+            memcpy(begin_, bytes, size);
+            begin_ += size;
+            return;
+        }
+        auto const chunk_size = pool_->chunk_size();
+        if (size >= chunk_size) {
+            auto chunk = std::unique_ptr<std::byte[]>{ new std::byte[size] };
+            memcpy(chunk.get(), bytes, size);
+            push_chunk(std::move(chunk), size, false);
+            begin_ = end_;
+            return;
+        }
+        if (available > 0) {
+            memcpy(begin_, bytes, available);
+            begin_ = end_;
+        }
+        push_chunk(pool_->acquire(), chunk_size, true);
+        memcpy(begin_, bytes + available, size - available);
+        begin_ += size - available;
+    }
+
+    // Returns the written bytes as a list of contiguous spans.
+    std::vector<span<std::byte const>> chunks() const {
+        auto result = std::vector<span<std::byte const>>{};
+        result.reserve(chunks_.size());
+        for_each_chunk([&] (span<std::byte const> c) {
+            result.push_back(c);
+        });
+        return result;
+    }
+
+    // Copies the written bytes to a contiguous buffer of at least size() bytes.
+    void copy_to(std::byte* data) const noexcept {
+        for_each_chunk([&] (span<std::byte const> c) {
+            memcpy(data, c.data(), c.size());
+            data += c.size();
+        });
+    }
+    std::vector<std::byte> to_vector() const {
+        auto result = std::vector<std::byte>(size_);
+        copy_to(result.data());
+        return result;
+    }
+
+    // Gives the chunks back to the pool.
+    void clear() {
+        for (auto& c : chunks_) {
+            if (c.pooled) pool_->release(std::move(c.data));
+        }
+        chunks_.clear();
+        begin_ = end_ = nullptr;
+        size_ = 0;
+    }
+};
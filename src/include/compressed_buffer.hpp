@@ -0,0 +1,238 @@
+#pragma once
+
+#include <lz_compression.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+// Compressed streams are a sequence of blocks, compressed independently. Each block starts
+// with its compressed size and its decompressed size, on 4 bytes each. The highest bit of
+// the compressed size marks blocks stored as is, because compression didn't shrink them.
+
+namespace detail::compression {
+    constexpr size_t header_size = 2 * sizeof(uint32_t);
+    constexpr uint32_t stored_flag = 0x80000000u;
+}
+
+// A block of a compressed stream.
+struct compressed_block {
+    span<std::byte const> data; // Compressed bytes, without the header.
+    size_t offset;              // Position of the block in the decompressed stream.
+    size_t size;                // Decompressed size.
+    bool is_stored;
+};
+
+// Reads the header of the block starting at data, fails if it is truncated.
+inline bool read_compressed_block(span<std::byte const> data, size_t offset, compressed_block& block) noexcept {
+    using namespace detail::compression;
+    if (data.size() < header_size) return false;
+
+    uint32_t stored_size, size;
+    memcpy(&stored_size, data.data(), sizeof(stored_size));
+    memcpy(&size, data.data() + sizeof(stored_size), sizeof(size));
+    auto const is_stored = (stored_size & stored_flag) != 0;
+    stored_size &= ~stored_flag;
+
+    if (data.size() - header_size < stored_size) return false;
+    if (is_stored && stored_size != size) return false;
+    block = { { data.data() + header_size, stored_size }, offset, size, is_stored };
+    return true;
+}
+
+// Lists the blocks of a compressed stream, which can then be decompressed in parallel.
+// Fails if the stream is truncated.
+inline bool get_compressed_blocks(span<std::byte const> data, std::vector<compressed_block>& blocks) {
+    size_t offset = 0;
+    while (data.size() > 0) {
+        compressed_block block;
+        if (!read_compressed_block(data, offset, block)) return false;
+        blocks.push_back(block);
+        offset += block.size;
+        data.begin() = block.data.end();
+    }
+    return true;
+}
+
+// Writes block.size bytes, fails if the block is corrupted.
+inline bool decompress_block(compressed_block const& block, std::byte* data) noexcept {
+    if (block.is_stored) {
+        if (block.size > 0) memcpy(data, block.data.data(), block.size);
+        return true;
+    }
+    return lz_decompress(block.data, span<std::byte>{ data, block.size });
+}
+
+// Output buffer which compresses what is written to it by blocks, and writes them to a
+// destination : either a span<std::byte> such as a binary_ostream, or a growable buffer with
+// a 'write(data, size)' method. The last block is only written by flush().
+template <class Destination>
+class compressing_writer {
+    Destination* destination_;
+    size_t block_size_;
+    std::unique_ptr<std::byte[]> block_;
+    std::unique_ptr<std::byte[]> compressed_;
+    size_t filled_ = 0;
+    size_t size_ = 0;
+    bool overflow_ = false;
+
+    void write_destination(void const* data, size_t size) {
+        if constexpr (std::is_convertible_v<Destination&, span<std::byte>&>) {
+            auto& out = static_cast<span<std::byte>&>(*destination_);
+            if (overflow_ || out.size() < size) {
+                overflow_ = true;
+                return;
+            }
+            memcpy(out.data(), data, size);
+            out.begin() += size;
+        }
+        else {
+            destination_->write(data, size);
+        }
+    }
+    void write_block() {
+        using namespace detail::compression;
+        auto const compressed_size = lz_compress({ block_.get(), filled_ }, compressed_.get() + header_size);
+        auto const is_stored = compressed_size >= filled_;
+        auto const stored_size = static_cast<uint32_t>(is_stored ? filled_ : compressed_size);
+        auto const size = static_cast<uint32_t>(filled_);
+
+        auto const header = static_cast<uint32_t>(stored_size | (is_stored ? stored_flag : 0));
+        memcpy(compressed_.get(), &header, sizeof(header));
+        memcpy(compressed_.get() + sizeof(header), &size, sizeof(size));
+        if (is_stored) {
+            write_destination(compressed_.get(), header_size);
+            write_destination(block_.get(), filled_);
+        }
+        else {
+            write_destination(compressed_.get(), header_size + stored_size);
+        }
+        filled_ = 0;
+    }
+public:
+    // Blocks are limited to 2 GiB.
+    explicit compressing_writer(Destination& destination, size_t block_size = 64 * 1024) :
+        destination_{ &destination },
+        block_size_ { std::clamp<size_t>(block_size, 1, detail::compression::stored_flag - 1) },
+        block_      { new std::byte[block_size_] },
+        compressed_ { new std::byte[detail::compression::header_size + lz_compress_bound(block_size_)] }
+    {}
+
+    // Total number of bytes written, before compression.
+    size_t size() const noexcept { return size_; }
+
+    // True when a span destination was too small.
+    bool overflow() const noexcept { return overflow_; }
+
+    void write(void const* data, size_t size) {
+        auto bytes = static_cast<std::byte const*>(data);
+        size_ += size;
+        while (size > 0) {
+            auto const count = std::min(size, block_size_ - filled_);
+            memcpy(block_.get() + filled_, bytes, count);
+            filled_ += count;
+            bytes   += count;
+            size    -= count;
+            if (filled_ == block_size_) write_block();
+        }
+    }
+
+    // Compresses and writes the pending bytes as a last, smaller block.
+    void flush() {
+        if (filled_ > 0) write_block();
+    }
+};
+
+// Input source which decompresses a compressed stream block by block, while it is read.
+// The current block is shared between the copies of the reader, which stay cheap to copy.
+// Blocks are decompressed when the reader reaches them : a block which fails to decompress
+// ends the stream there, and sets corrupted(). When it is reached in the middle of a read,
+// the read fails, which fails the checked deserializations. A truncated stream ends at its
+// last complete block.
+class decompressing_reader {
+    struct block_cache {
+        std::vector<std::byte> data;
+        std::byte const* header = nullptr;
+    };
+    std::shared_ptr<block_cache> cache_;
+    std::byte const* header_;
+    std::byte const* end_;
+    compressed_block block_{};
+    size_t position_ = 0;
+    size_t size_ = 0;
+    bool corrupted_ = false;
+
+    void next_block() {
+        while (position_ == block_.size && header_ != end_) {
+            header_ = block_.data.end();
+            position_ = 0;
+            if (header_ == end_) return;
+            read_compressed_block({ header_, end_ }, 0, block_);
+            if (!load_block()) {
+                size_ = 0;
+                corrupted_ = true;
+                return;
+            }
+        }
+    }
+    bool load_block() {
+        if (cache_->header == header_) return true;
+        cache_->header = nullptr;
+        cache_->data.resize(block_.size);
+        if (!decompress_block(block_, cache_->data.data())) return false;
+        cache_->header = header_;
+        return true;
+    }
+public:
+    explicit decompressing_reader(span<std::byte const> data) :
+        cache_ { std::make_shared<block_cache>() },
+        header_{ data.begin() },
+        end_   { data.begin() }
+    {
+        compressed_block block;
+        while (read_compressed_block({ end_, data.end() }, 0, block)) {
+            size_ += block.size;
+            end_ = block.data.end();
+        }
+        if (header_ == end_) return;
+        read_compressed_block({ header_, end_ }, 0, block_);
+        if (!load_block()) {
+            size_ = 0;
+            corrupted_ = true;
+        }
+    }
+
+    // Remaining number of bytes, after decompression.
+    size_t size() const noexcept { return size_; }
+
+    bool corrupted() const noexcept { return corrupted_; }
+
+    // Fails when it reaches a corrupted block, whose bytes are left zeroed.
+    bool read(void* data, size_t size) {
+        assert(size <= size_);
+        auto bytes = static_cast<std::byte*>(data);
+        size_ -= size;
+        while (size > 0) {
+            if (corrupted_ || !load_block()) {
+                memset(bytes, 0, size);
+                size_ = 0;
+                corrupted_ = true;
+                return false;
+            }
+            auto const count = std::min(size, block_.size - position_);
+            memcpy(bytes, cache_->data.data() + position_, count);
+            position_ += count;
+            bytes     += count;
+            size      -= count;
+            next_block();
+        }
+        return true;
+    }
+
+    // Decompressed bytes don't outlive their block, so views can't alias them.
+    std::byte const* read_view(size_t, size_t) noexcept {
+        return nullptr;
+    }
+};
@@ -111,12 +111,12 @@ namespace detail::no_adl {
     }
 
     template <class T>
-    void try_reserve(T& range) {
+    void try_reserve(T& range, size_t size) {
         constexpr auto expr = [] (auto& arg) -> decltype(
-            arg.reserve()
+            arg.reserve(size_t{})
         ) {};
         if constexpr (std::is_invocable_v<decltype(expr), T&>) {
-            range.reserve();
+            range.reserve(size);
         }
     }
 }
@@ -124,12 +124,65 @@ namespace detail::no_adl {
 template <class T>
 constexpr auto is_container_v = is_range_v<T> && detail::no_adl::has_emplace<T>();
 
+// NodeContainer (node-based associative containers, which can extract their nodes)
+
+namespace detail::no_adl {
+    template <class T>
+    constexpr bool has_extract() noexcept {
+        constexpr auto expr = [] (auto& container) -> decltype(
+            container.extract(container.begin())
+        ) {};
+        return std::is_invocable_v<decltype(expr), T&>;
+    }
+    template <class Node>
+    constexpr bool has_key() noexcept {
+        constexpr auto expr = [] (auto& node) -> decltype(
+            node.key()
+        ) {};
+        return std::is_invocable_v<decltype(expr), Node&>;
+    }
+}
+
+template <class T>
+constexpr bool is_node_container_v = is_container_v<T> && detail::no_adl::has_extract<T>();
+
+// OrderedContainer (sorted associative containers, tree-based or flat)
+
+namespace detail::no_adl {
+    template <class T>
+    constexpr bool has_key_comp() noexcept {
+        constexpr auto expr = [] (auto& container) -> decltype(
+            container.key_comp()
+        ) {};
+        return std::is_invocable_v<decltype(expr), T&>;
+    }
+    template <class T>
+    constexpr bool has_emplace_hint() noexcept {
+        constexpr auto expr = [] (auto& container) -> decltype(
+            container.emplace_hint(container.end())
+        ) {};
+        return std::is_invocable_v<decltype(expr), T&>;
+    }
+}
+
+// Elements inserted in increasing order with an end hint are placed in amortized constant time.
+template <class T>
+constexpr bool is_ordered_container_v = is_container_v<T>
+                                     && detail::no_adl::has_key_comp<T>()
+                                     && detail::no_adl::has_emplace_hint<T>();
+
 template <class Container>
 struct container_traits : range_traits<Container> {
     static_assert(is_container_v<Container>);
     template <class...Args>
     static constexpr decltype(auto) emplace(Container& c, Args&&...args) { return detail::no_adl::call_emplace(c, FWD(args)...); }
-    static constexpr void try_reserve(Container& c) { detail::no_adl::try_reserve(c); }
+    static constexpr void try_reserve(Container& c, size_t size) { detail::no_adl::try_reserve(c, size); }
+    // Inserts after the last element of ordered containers, which must stay sorted.
+    template <class...Args>
+    static constexpr decltype(auto) emplace_back(Container& c, Args&&...args) {
+        if constexpr (is_ordered_container_v<Container>) return c.emplace_hint(c.end(), FWD(args)...);
+        else return detail::no_adl::call_emplace(c, FWD(args)...);
+    }
 };
 
 // Array
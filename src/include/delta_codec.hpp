@@ -0,0 +1,280 @@
+#pragma once
+
+#include <span.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DELTA_CODEC_SSE2
+#endif
+
+// Integers are encoded as the zigzag of their difference with the previous one, and bit packed
+// by blocks of 128 values with the width of the largest zigzag of the block.
+// A block starts with its width on one byte. Full blocks interleave their values in four lanes
+// of 32 bits (or two lanes of 64 bits), so that four consecutive values are unpacked and summed
+// at once with SIMD instructions. The last partial block is packed sequentially.
+// Values up to 32 bits are computed on 32 bits, bigger ones on 64 bits.
+
+namespace detail::delta {
+    constexpr size_t block_size = 128;
+    constexpr size_t lanes_size = 16;
+
+    template <class T>
+    using word_t = std::conditional_t<sizeof(T) <= 4, uint32_t, uint64_t>;
+    template <class U>
+    constexpr unsigned word_bits = sizeof(U) * 8;
+    template <class U>
+    constexpr size_t lanes_count = lanes_size / sizeof(U);
+
+    template <class T>
+    constexpr word_t<T> to_word(T value) noexcept {
+        // Signed values are sign extended, so that small negative differences stay small.
+        using U = word_t<T>;
+        if constexpr (std::is_signed_v<T>) return static_cast<U>(static_cast<std::make_signed_t<U>>(value));
+        else return static_cast<U>(value);
+    }
+    template <class U>
+    constexpr U zigzag(U value) noexcept {
+        return (value << 1) ^ static_cast<U>(static_cast<std::make_signed_t<U>>(value) >> (word_bits<U> - 1));
+    }
+    template <class U>
+    constexpr U unzigzag(U value) noexcept {
+        return (value >> 1) ^ (U{ 0 } - (value & 1));
+    }
+    template <class U>
+    constexpr unsigned get_width(U value) noexcept {
+        unsigned width = 0;
+        for (; value != 0; value >>= 1) ++width;
+        return width;
+    }
+
+    constexpr size_t get_packed_size(size_t count, unsigned width) noexcept {
+        return count == block_size ? lanes_size * width : (count * width + 7) / 8;
+    }
+
+    // Value i of a block goes to the lane i % Lanes, lanes being streams of words.
+    template <size_t Lanes, class U>
+    void pack(U const* values, size_t count, unsigned width, U* words) noexcept {
+        constexpr auto bits = word_bits<U>;
+        std::fill(words, words + block_size, U{ 0 });
+        if (width == 0) return;
+        for (size_t i = 0, offset = 0; i < count; i += Lanes, offset += width) {
+            auto const word  = (offset / bits) * Lanes;
+            auto const shift = offset % bits;
+            for (size_t l = 0; l < Lanes && i + l < count; ++l) {
+                words[word + l] |= values[i + l] << shift;
+                if (shift + width > bits) words[word + Lanes + l] |= values[i + l] >> (bits - shift);
+            }
+        }
+    }
+    template <size_t Lanes, class U>
+    void unpack(U const* words, size_t count, unsigned width, U* values) noexcept {
+        constexpr auto bits = word_bits<U>;
+        auto const mask = width == bits ? ~U{ 0 } : (U{ 1 } << width) - 1;
+        if (width == 0) {
+            std::fill(values, values + count, U{ 0 });
+            return;
+        }
+        for (size_t i = 0, offset = 0; i < count; i += Lanes, offset += width) {
+            auto const word  = (offset / bits) * Lanes;
+            auto const shift = offset % bits;
+            for (size_t l = 0; l < Lanes && i + l < count; ++l) {
+                auto value = words[word + l] >> shift;
+                if (shift + width > bits) value |= words[word + Lanes + l] << (bits - shift);
+                values[i + l] = value & mask;
+            }
+        }
+    }
+
+    template <class T, class U>
+    void sum_deltas(U const* deltas, size_t count, U& previous, T* values) noexcept {
+        for (size_t i = 0; i < count; ++i) {
+            previous += unzigzag(deltas[i]);
+            values[i] = static_cast<T>(previous);
+        }
+    }
+
+#ifdef DELTA_CODEC_SSE2
+    // Unpacks four (or two) consecutive values per iteration, then sums them with the previous ones.
+    template <class T, class U>
+    void decode_block(std::byte const* data, unsigned width, U& previous, T* values) noexcept {
+        constexpr auto bits  = word_bits<U>;
+        constexpr auto lanes = lanes_count<U>;
+        constexpr bool is_32 = sizeof(U) == 4;
+
+        auto const mask = is_32
+            ? _mm_set1_epi32(static_cast<int>(width == 32 ? ~0u : (1u << width) - 1))
+            : _mm_set1_epi64x(static_cast<long long>(width == 64 ? ~0ull : (1ull << width) - 1));
+        auto sum = is_32
+            ? _mm_set1_epi32(static_cast<int>(previous))
+            : _mm_set1_epi64x(static_cast<long long>(previous));
+        auto const one  = is_32 ? _mm_set1_epi32(1) : _mm_set1_epi64x(1);
+        auto const zero = _mm_setzero_si128();
+        auto const words = reinterpret_cast<__m128i const*>(data);
+
+        for (size_t j = 0; j < block_size / lanes; ++j) {
+            auto const offset = static_cast<unsigned>(j) * width;
+            auto const word   = offset / bits;
+            auto const shift  = offset % bits;
+
+            auto v = zero;
+            if (width != 0) {
+                auto const w = _mm_loadu_si128(words + word);
+                v = is_32 ? _mm_srl_epi32(w, _mm_cvtsi32_si128(static_cast<int>(shift)))
+                          : _mm_srl_epi64(w, _mm_cvtsi32_si128(static_cast<int>(shift)));
+                if (shift + width > bits) {
+                    auto const next = _mm_loadu_si128(words + word + 1);
+                    auto const high = is_32 ? _mm_sll_epi32(next, _mm_cvtsi32_si128(static_cast<int>(bits - shift)))
+                                            : _mm_sll_epi64(next, _mm_cvtsi32_si128(static_cast<int>(bits - shift)));
+                    v = _mm_or_si128(v, high);
+                }
+                v = _mm_and_si128(v, mask);
+            }
+            if constexpr (is_32) {
+                v = _mm_xor_si128(_mm_srli_epi32(v, 1), _mm_sub_epi32(zero, _mm_and_si128(v, one)));
+                v = _mm_add_epi32(v, _mm_slli_si128(v, 4));
+                v = _mm_add_epi32(v, _mm_slli_si128(v, 8));
+                v = _mm_add_epi32(v, sum);
+                sum = _mm_shuffle_epi32(v, 0xFF);
+            }
+            else {
+                v = _mm_xor_si128(_mm_srli_epi64(v, 1), _mm_sub_epi64(zero, _mm_and_si128(v, one)));
+                v = _mm_add_epi64(v, _mm_slli_si128(v, 8));
+                v = _mm_add_epi64(v, sum);
+                sum = _mm_shuffle_epi32(v, 0xEE);
+            }
+
+            auto const out = values + j * lanes;
+            if constexpr (sizeof(T) == sizeof(U)) {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out), v);
+            }
+            else {
+                U results[lanes];
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(results), v);
+                for (size_t l = 0; l < lanes; ++l) out[l] = static_cast<T>(results[l]);
+            }
+        }
+        U last[lanes];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(last), sum);
+        previous = last[0];
+    }
+#else
+    template <class T, class U>
+    void decode_block(std::byte const* data, unsigned width, U& previous, T* values) noexcept {
+        U words[block_size], deltas[block_size];
+        memcpy(words, data, get_packed_size(block_size, width));
+        unpack<lanes_count<U>>(words, block_size, width, deltas);
+        sum_deltas(deltas, block_size, previous, values);
+    }
+#endif
+
+    // Calls f(first value, count, width, packed data) for each block, or returns false if the data is invalid.
+    template <class U, class F>
+    bool for_each_block(size_t count, span<std::byte const> data, F&& f) noexcept {
+        auto ptr = data.begin();
+        for (size_t begin = 0; begin < count; begin += block_size) {
+            if (ptr == data.end()) return false;
+            auto const width = static_cast<unsigned>(*ptr++);
+            if (width > word_bits<U>) return false;
+
+            auto const n    = std::min(block_size, count - begin);
+            auto const size = get_packed_size(n, width);
+            if (static_cast<size_t>(data.end() - ptr) < size) return false;
+            f(begin, n, width, ptr);
+            ptr += size;
+        }
+        return ptr == data.end();
+    }
+}
+
+struct delta_codec {
+    template <class T>
+    static void check_type() noexcept {
+        static_assert(std::is_integral_v<T> && !std::is_same_v<T, bool>, "The delta codec only encodes integers");
+    }
+
+    // Each block takes at least one byte.
+    static constexpr bool is_possible_count(size_t count, size_t size) noexcept {
+        return count / detail::delta::block_size + (count % detail::delta::block_size != 0) <= size;
+    }
+
+    template <class T>
+    static size_t get_encoded_size(T const* values, size_t count) noexcept {
+        check_type<T>();
+        using namespace detail::delta;
+        using U = word_t<T>;
+
+        size_t size = 0;
+        U previous = 0;
+        for (size_t begin = 0; begin < count; begin += block_size) {
+            auto const n = std::min(block_size, count - begin);
+            U bits = 0;
+            for (size_t i = begin; i < begin + n; ++i) {
+                auto const word = to_word(values[i]);
+                bits |= zigzag(static_cast<U>(word - previous));
+                previous = word;
+            }
+            size += 1 + get_packed_size(n, get_width(bits));
+        }
+        return size;
+    }
+
+    // Writes get_encoded_size(values, count) bytes.
+    template <class T>
+    static void encode(T const* values, size_t count, std::byte* data) noexcept {
+        check_type<T>();
+        using namespace detail::delta;
+        using U = word_t<T>;
+
+        U previous = 0;
+        U deltas[block_size], words[block_size];
+        for (size_t begin = 0; begin < count; begin += block_size) {
+            auto const n = std::min(block_size, count - begin);
+            U bits = 0;
+            for (size_t i = 0; i < n; ++i) {
+                auto const word = to_word(values[begin + i]);
+                deltas[i] = zigzag(static_cast<U>(word - previous));
+                bits |= deltas[i];
+                previous = word;
+            }
+            auto const width = get_width(bits);
+            *data++ = static_cast<std::byte>(width);
+
+            if (n == block_size) pack<lanes_count<U>>(deltas, n, width, words);
+            else pack<1>(deltas, n, width, words);
+            memcpy(data, words, get_packed_size(n, width));
+            data += get_packed_size(n, width);
+        }
+    }
+
+    // Fails if the data doesn't hold exactly count values.
+    template <class T>
+    static bool decode(T* values, size_t count, span<std::byte const> data) noexcept {
+        check_type<T>();
+        using namespace detail::delta;
+        using U = word_t<T>;
+
+        U previous = 0;
+        return for_each_block<U>(count, data, [&] (size_t begin, size_t n, unsigned width, std::byte const* packed) {
+            if (n == block_size) {
+                decode_block(packed, width, previous, values + begin);
+            }
+            else {
+                U words[block_size], deltas[block_size];
+                memcpy(words, packed, get_packed_size(n, width));
+                unpack<1>(words, n, width, deltas);
+                sum_deltas(deltas, n, previous, values + begin);
+            }
+        });
+    }
+
+    template <class T>
+    static bool validate(size_t count, span<std::byte const> data) noexcept {
+        check_type<T>();
+        using U = detail::delta::word_t<T>;
+        return detail::delta::for_each_block<U>(count, data, [] (size_t, size_t, unsigned, std::byte const*) {});
+    }
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+
+// Formats are policy structures selecting how values are laid out on the wire.
+// Derive from one of them and override members to combine options.
+
+enum class size_encoding {
+    fixed,   // size_t, native representation
+    varint,  // LEB128, 1 byte up to 127 elements
+    fixed64, // uint64_t, in the byte order of the format
+};
+
+enum class trivial_layout {
+    native, // memory representation, padding included
+    packed, // fields only, for trivially copyable aggregates of standard layout
+};
+
+// Scalars of trivial values (arithmetic types and enums, alone or in arrays and aggregates)
+// are written in the byte order of the format. When it is the host one, they are copied as is.
+enum class byte_order {
+    native, // host byte order
+    little,
+    big,
+};
+
+// Large containers and dynamic arrays can be followed by an index of their elements, so that
+// they are decoded in parallel (see parallel_deserialize) : the serialized size of all their
+// elements is written before them, and the sizes of their blocks of range_index_stride
+// elements after them, except for the last block.
+enum class range_index {
+    none,   // elements only
+    blocks, // for ranges of more than range_index_stride elements
+};
+
+constexpr size_t range_index_stride = 1024;
+
+enum class string_encoding {
+    plain,    // every string is written in full
+    interned, // repeated strings of a message reference the first one, through an interning stream
+};
+
+struct native_format {
+    static constexpr auto sizes      = size_encoding::fixed;
+    static constexpr auto layout     = trivial_layout::native;
+    static constexpr auto strings    = string_encoding::plain;
+    static constexpr auto endianness = byte_order::native;
+    static constexpr auto ranges     = range_index::none;
+};
+
+struct compact_format : native_format {
+    static constexpr auto sizes = size_encoding::varint;
+};
+
+// Aggregates with C arrays, or members without implicit conversion, are still copied
+// with their padding. Bit-fields are not supported.
+struct packed_format : native_format {
+    static constexpr auto layout = trivial_layout::packed;
+};
+
+// Applies to std::string and std::string_view. Strings are referenced by their index in the
+// dictionary of the stream, so get_serialized_size gives an upper bound.
+struct interned_format : compact_format {
+    static constexpr auto strings = string_encoding::interned;
+};
+
+// Readable by any host : sizes on 8 bytes, scalars in little endian, aggregates without padding.
+// Views can only alias the buffer on little endian hosts, and array codecs write their own layout.
+struct portable_format : native_format {
+    static constexpr auto sizes      = size_encoding::fixed64;
+    static constexpr auto layout     = trivial_layout::packed;
+    static constexpr auto endianness = byte_order::little;
+};
+
+struct indexed_format : native_format {
+    static constexpr auto ranges = range_index::blocks;
+};
@@ -0,0 +1,406 @@
+#pragma once
+
+#include <serialization.hpp>
+#include <vector>
+
+// Offset tables let a lazy_reader reach a field of a tuple or aggregate, or an element of a
+// range, in constant time, and decode only what it reads. serialize_with_tables writes the
+// value as serialize does, followed by its offset tables and by the size of the value on
+// 8 bytes. Tables are only written for the parts whose layout depends on the values :
+//   tuples and aggregates without a static size : the offsets of their fields which follow
+//     a field without a static size,
+//   ranges of elements without a static size : the offset of each element.
+// The tables of the parts of a value follow its own table. When their size depends on the
+// values, the table also holds their position. Entries are unsigned integers on 8 bytes, in
+// the byte order of the format.
+
+namespace detail::lazy {
+    constexpr size_t entry_size = sizeof(uint64_t);
+
+    // Position of a part whose offset or tables are stored, or read from a corrupted table.
+    constexpr size_t unknown = SIZE_MAX;
+
+    template <class T>
+    constexpr bool is_tuple_node() noexcept {
+        constexpr auto category = serialization_category_v<T>;
+        return category == serialization_category::tuple || category == serialization_category::aggregate;
+    }
+    template <class T>
+    constexpr bool is_range_node() noexcept {
+        constexpr auto category = serialization_category_v<T>;
+        return category == serialization_category::container
+            || category == serialization_category::fixed_array
+            || category == serialization_category::dynamic_array;
+    }
+
+    template <class T, bool IsAggregate = serialization_category_v<T> == serialization_category::aggregate>
+    struct node_fields {
+        using type = T;
+    };
+    template <class T>
+    struct node_fields<T, true> {
+        using type = field_types_t<T>;
+    };
+    template <class T>
+    using node_fields_t = typename node_fields<T>::type;
+
+    template <class T>
+    decltype(auto) get_fields(T const& value) noexcept {
+        if constexpr (serialization_category_v<T> == serialization_category::aggregate) return as_tuple(value);
+        else return (value);
+    }
+
+    template <class T, class Format>
+    constexpr size_t get_static_size() noexcept {
+        if constexpr (has_static_serialized_size_v<T, Format>) return serialized_size_v<T, Format>;
+        else return 0;
+    }
+
+    template <class T, class Format>
+    constexpr bool has_tables() noexcept {
+        if constexpr (is_tuple_node<T>()) {
+            return !has_static_serialized_size_v<T, Format>;
+        }
+        else if constexpr (is_range_node<T>()) {
+            return !has_static_serialized_size_v<typename range_traits<T>::value_type, Format>;
+        }
+        else {
+            return false;
+        }
+    }
+
+    // Size of the tables of a value and of its parts, or unknown when it depends on the values.
+    template <class T, class Format>
+    constexpr size_t get_tables_size() noexcept;
+
+    // Where the offsets and tables of the fields of a tuple or aggregate are, relatively to the
+    // value and to its table. Offsets of the fields of a bit run are the offset of the run.
+    template <size_t N>
+    struct fields_layout {
+        std::array<size_t, N> offsets{};        // static offset, or unknown
+        std::array<size_t, N> offset_entries{}; // position of the offset in the table, or unknown
+        std::array<size_t, N> tables{};         // static position of the tables, or unknown
+        std::array<size_t, N> table_entries{};  // position of the tables position in the table, or unknown
+        size_t table_size  = 0;
+        size_t tables_size = 0;                 // own table and tables of the fields, or unknown
+    };
+
+    template <class T, class Format, size_t...Is>
+    constexpr auto get_fields_layout(std::index_sequence<Is...>) noexcept {
+        using fields = node_fields_t<T>;
+        constexpr auto count = sizeof...(Is);
+        constexpr auto& plan = bit_plan_v<fields>;
+        constexpr bool is_bits[]     = { is_bit_packed_v<remove_cvref_t<std::tuple_element_t<Is, fields>>>..., false };
+        constexpr bool is_static[]   = { has_static_serialized_size_v<std::tuple_element_t<Is, fields>, Format>..., true };
+        constexpr size_t sizes[]     = { get_static_size<std::tuple_element_t<Is, fields>, Format>()..., 0 };
+        constexpr size_t tables[]    = { get_tables_size<std::tuple_element_t<Is, fields>, Format>()..., 0 };
+        constexpr bool has_tables_[] = { has_tables<std::tuple_element_t<Is, fields>, Format>()..., false };
+
+        auto layout = fields_layout<count>{};
+        auto is_static_subtree = true;
+        for (size_t i = 0; i < count; ++i) is_static_subtree = is_static_subtree && tables[i] != unknown;
+
+        size_t offset = 0;
+        size_t run_offset = 0;
+        auto is_static_offset = true;
+        for (size_t i = 0; i < count; ++i) {
+            if (is_bits[i] && plan.slots[i].is_first) run_offset = offset;
+            auto const field_offset = is_bits[i] ? run_offset : offset;
+            layout.offsets[i] = is_static_offset ? field_offset : unknown;
+            layout.offset_entries[i] = unknown;
+            if (!is_static_offset) {
+                layout.offset_entries[i] = layout.table_size;
+                layout.table_size += entry_size;
+            }
+            layout.table_entries[i] = unknown;
+            if (has_tables_[i] && !is_static_subtree) {
+                layout.table_entries[i] = layout.table_size;
+                layout.table_size += entry_size;
+            }
+            if (is_bits[i]) offset += plan.slots[i].is_first ? plan.slots[i].run_size : 0;
+            else offset += sizes[i];
+            is_static_offset = is_static_offset && is_static[i];
+        }
+        size_t position = layout.table_size;
+        for (size_t i = 0; i < count; ++i) {
+            layout.tables[i] = is_static_subtree ? position : unknown;
+            if (is_static_subtree) position += tables[i];
+        }
+        layout.tables_size = is_static_subtree ? position : unknown;
+        return layout;
+    }
+
+    template <class T>
+    constexpr size_t get_fields_count() noexcept {
+        if constexpr (serialization_category_v<T> == serialization_category::aggregate) return airity_v<T>;
+        else return std::tuple_size_v<T>;
+    }
+
+    template <class T, class Format>
+    constexpr auto fields_layout_v = get_fields_layout<T, Format>(std::make_index_sequence<get_fields_count<T>()>{});
+
+    template <class T, class Format>
+    constexpr size_t get_tables_size() noexcept {
+        if constexpr (!has_tables<T, Format>()) {
+            return 0;
+        }
+        else if constexpr (is_tuple_node<T>()) {
+            return fields_layout_v<T, Format>.tables_size;
+        }
+        else {
+            return unknown;
+        }
+    }
+
+    // Entries of the table of a range : the offset of each element, and the position of its
+    // tables when their size depends on the values.
+    template <class T, class Format>
+    constexpr size_t get_element_entry_size() noexcept {
+        using value_type = typename range_traits<T>::value_type;
+        constexpr auto has_position = has_tables<value_type, Format>() && get_tables_size<value_type, Format>() == unknown;
+        return entry_size * (has_position ? 2 : 1);
+    }
+
+    template <class Format>
+    void write_entry(std::vector<std::byte>& tables, size_t position, size_t value) noexcept {
+        auto word = static_cast<uint64_t>(value);
+        if constexpr (is_foreign_order_v<Format>) word = byte_swap::swap_word(word);
+        memcpy(tables.data() + position, &word, sizeof(word));
+    }
+    // Returns unknown when the entry is out of the tables.
+    template <class Format>
+    size_t read_entry(span<std::byte const> tables, size_t position) noexcept {
+        if (position > tables.size() || tables.size() - position < entry_size) return unknown;
+        uint64_t word;
+        memcpy(&word, tables.data() + position, sizeof(word));
+        if constexpr (is_foreign_order_v<Format>) word = byte_swap::swap_word(word);
+        return word > SIZE_MAX ? unknown : static_cast<size_t>(word);
+    }
+
+    // Appends the tables of the value and of its parts, returns its serialized size.
+    template <class Format, class T>
+    size_t build_tables(T const& value, std::vector<std::byte>& tables);
+
+    template <class Format, class T, size_t...Is>
+    size_t build_fields_tables(T const& value, std::vector<std::byte>& tables, std::index_sequence<Is...>) {
+        using fields = node_fields_t<T>;
+        constexpr auto& layout = fields_layout_v<T, Format>;
+        auto const table = tables.size();
+        tables.resize(table + layout.table_size);
+
+        auto const& values = get_fields(value);
+        size_t offset = 0;
+        size_t run_offset = 0;
+        ([&] {
+            using field = std::tuple_element_t<Is, fields>;
+            auto const& field_value = std::get<Is>(values);
+            if constexpr (is_bit_packed_v<remove_cvref_t<field>>) {
+                if constexpr (bit_plan_v<fields>.slots[Is].is_first) run_offset = offset;
+            }
+            if constexpr (layout.offset_entries[Is] != unknown) {
+                auto const field_offset = is_bit_packed_v<remove_cvref_t<field>> ? run_offset : offset;
+                write_entry<Format>(tables, table + layout.offset_entries[Is], field_offset);
+            }
+            if constexpr (has_tables<field, Format>()) {
+                if constexpr (layout.table_entries[Is] != unknown) {
+                    write_entry<Format>(tables, table + layout.table_entries[Is], tables.size());
+                }
+                offset += build_tables<Format>(field_value, tables);
+            }
+            else {
+                offset += get_field_size<Format, fields, Is>(field_value);
+            }
+        }(), ...);
+        return offset;
+    }
+
+    template <class Format, class T>
+    size_t build_range_tables(T const& range, std::vector<std::byte>& tables) {
+        using traits = range_traits<T>;
+        constexpr auto entry = get_element_entry_size<T, Format>();
+        auto const count = static_cast<size_t>(traits::size(range));
+        auto const table = tables.size();
+        tables.resize(table + count * entry);
+
+        // Offsets are relative to the first element until the size of the count is known.
+        auto offsets = std::vector<size_t>(count);
+        auto block_sizes = std::vector<size_t>{};
+        auto const is_indexed = has_range_index<T, Format>(count);
+        if (is_indexed) block_sizes.resize(get_blocks_count(count));
+
+        size_t offset = 0;
+        auto it = traits::begin(range);
+        for (size_t i = 0; i < count; ++i, ++it) {
+            offsets[i] = offset;
+            if constexpr (entry > entry_size) {
+                write_entry<Format>(tables, table + i * entry + entry_size, tables.size());
+            }
+            auto const size = build_tables<Format>(*it, tables);
+            if (is_indexed) block_sizes[i / range_index_stride] += size;
+            offset += size;
+        }
+
+        size_t header_size = 0;
+        if constexpr (serialization_category_v<T> != serialization_category::fixed_array) {
+            header_size += get_serialized_size_size<Format>(count);
+        }
+        size_t index_size = 0;
+        if (is_indexed) {
+            header_size += get_serialized_size_size<Format>(offset);
+            for (size_t i = 0; i + 1 < block_sizes.size(); ++i) index_size += get_serialized_size_size<Format>(block_sizes[i]);
+        }
+        for (size_t i = 0; i < count; ++i) write_entry<Format>(tables, table + i * entry, header_size + offsets[i]);
+        return header_size + offset + index_size;
+    }
+
+    template <class Format, class T>
+    size_t build_tables(T const& value, std::vector<std::byte>& tables) {
+        if constexpr (!has_tables<T, Format>()) {
+            return get_serialized_size<Format>(value);
+        }
+        else if constexpr (is_tuple_node<T>()) {
+            return build_fields_tables<Format>(value, tables, std::make_index_sequence<get_fields_count<T>()>{});
+        }
+        else {
+            return build_range_tables<Format>(value, tables);
+        }
+    }
+}
+
+// Writes the value as serialize does, followed by its offset tables and by its size on 8 bytes.
+template <class Format = native_format, class T, class Buffer>
+void serialize_with_tables(T const& value, Buffer& buffer) {
+    static_assert(Format::strings != string_encoding::interned, "Interned strings have no size before they are written");
+    auto tables = std::vector<std::byte>{};
+    auto const size = static_cast<uint64_t>(detail::lazy::build_tables<Format>(value, tables));
+    serialize<Format>(value, buffer);
+    detail::write_bytes<false>(tables.data(), tables.size(), buffer);
+    detail::write_trivials<Format, false>(&size, 1, buffer);
+}
+
+// Part of a value written by serialize_with_tables, read on demand. Tuples and aggregates give
+// their fields with get<I>(), except bit packed fields which share their bytes with their
+// neighbours. Ranges give their elements with operator[], unless they are encoded, columnar
+// or interned. Readers are cheap to copy, and reference the buffer which must outlive them.
+// Offsets read from the tables are bounds checked : a corrupted table gives parts which fail
+// to be read.
+template <class T, class Format = native_format>
+class lazy_reader {
+    template <class, class>
+    friend class lazy_reader;
+
+    span<std::byte const> values_;
+    span<std::byte const> tables_;
+    size_t offset_ = 0;
+    size_t table_  = 0;
+
+    lazy_reader(span<std::byte const> values, span<std::byte const> tables, size_t offset, size_t table) noexcept :
+        values_{ values }, tables_{ tables }, offset_{ offset }, table_{ table }
+    {}
+
+    // Bytes of the value, up to the end of the top level value.
+    span<std::byte const> data() const noexcept {
+        if (offset_ > values_.size()) return { values_.end(), values_.end() };
+        return { values_.data() + offset_, values_.end() };
+    }
+    template <class Part>
+    lazy_reader<Part, Format> get_part(size_t offset, size_t table) const noexcept {
+        if (offset == detail::lazy::unknown || offset > values_.size() - std::min(offset_, values_.size())) {
+            return { values_, tables_, values_.size() + 1, tables_.size() };
+        }
+        return { values_, tables_, offset_ + offset, table };
+    }
+    // Size of the count, and of the elements size of indexed ranges, before the elements.
+    bool get_range_header(size_t& count, size_t& header_size) const noexcept {
+        if constexpr (serialization_category_v<T> == serialization_category::fixed_array) {
+            count = get_fixed_size<T>();
+            header_size = 0;
+            return true;
+        }
+        else {
+            auto buffer = data();
+            auto const begin = buffer.begin();
+            if (!detail::deserialize_size<Format, true>(count, buffer)) return false;
+            if (detail::has_range_index<T, Format>(count)) {
+                size_t elements_size;
+                if (!detail::deserialize_size<Format, true>(elements_size, buffer)) return false;
+            }
+            header_size = buffer.begin() - begin;
+            return true;
+        }
+    }
+public:
+    // Reads the size of the value at the end of the buffer. A buffer too small for it gives a
+    // reader which fails to read.
+    explicit lazy_reader(span<std::byte const> data) noexcept {
+        uint64_t size;
+        auto end = span<std::byte const>{ data.end() - std::min<size_t>(sizeof(size), data.size()), data.end() };
+        if (!detail::read_trivials<Format, true>(&size, 1, end) || size > data.size() - sizeof(size)) {
+            offset_ = 1;
+            return;
+        }
+        values_ = { data.data(), static_cast<size_t>(size) };
+        tables_ = { values_.end(), data.end() - sizeof(size) };
+    }
+
+    template <size_t I>
+    auto get() const noexcept {
+        static_assert(detail::lazy::is_tuple_node<T>(), "Only tuples and aggregates have fields");
+        using namespace detail::lazy;
+        using field = remove_cvref_t<std::tuple_element_t<I, node_fields_t<T>>>;
+        static_assert(!is_bit_packed_v<field>, "Bit packed fields share their bytes : read the enclosing value");
+
+        constexpr auto& layout = fields_layout_v<T, Format>;
+        auto offset = layout.offsets[I];
+        if constexpr (layout.offset_entries[I] != unknown) {
+            offset = read_entry<Format>(tables_, table_ + layout.offset_entries[I]);
+        }
+        auto table = table_ + layout.tables[I];
+        if constexpr (layout.table_entries[I] != unknown) {
+            table = read_entry<Format>(tables_, table_ + layout.table_entries[I]);
+        }
+        return get_part<field>(offset, table);
+    }
+
+    // Number of elements of a range, 0 when it can't be read.
+    size_t size() const noexcept {
+        static_assert(is_range_v<T>, "Only ranges have elements");
+        size_t count, header_size;
+        return get_range_header(count, header_size) ? count : 0;
+    }
+
+    auto operator[](size_t index) const noexcept {
+        using namespace detail::lazy;
+        using value_type = remove_cvref_t<typename range_traits<T>::value_type>;
+        constexpr auto category = serialization_category_v<T>;
+        static_assert(is_range_node<T>() || category == serialization_category::trivial_array
+                   || category == serialization_category::view, "The elements of the range aren't addressable");
+        static_assert(!detail::is_interned<T, Format>(), "Interned strings reference each other");
+
+        size_t count, header_size;
+        if (!get_range_header(count, header_size) || index >= count) return get_part<value_type>(unknown, 0);
+        if constexpr (has_tables<T, Format>()) {
+            constexpr auto entry = get_element_entry_size<T, Format>();
+            auto const offset = read_entry<Format>(tables_, table_ + index * entry);
+            auto table = table_ + count * entry + index * get_tables_size<value_type, Format>();
+            if constexpr (entry > entry_size) {
+                table = read_entry<Format>(tables_, table_ + index * entry + entry_size);
+            }
+            return get_part<value_type>(offset, table);
+        }
+        else {
+            return get_part<value_type>(header_size + index * serialized_size_v<value_type, Format>, 0);
+        }
+    }
+
+    // Decodes the value, checking the buffer bounds like try_deserialize.
+    bool try_read(T& value) const {
+        auto buffer = data();
+        return try_deserialize<Format>(value, buffer);
+    }
+    // Decodes the value without bounds checks.
+    T read() const {
+        auto buffer = data();
+        return deserialize<T, Format>(buffer);
+    }
+};
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <span.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+// Byte oriented LZ77 compression, in the format of LZ4 blocks : a sequence of
+//   token              4 bits of literals count, 4 bits of match length - 4
+//   [literals count]   when the token's is 15, continued by 255 bytes
+//   literals
+//   offset             2 bytes, little endian, from the current position back to the match
+//   [match length]     when the token's is 15, continued by 255 bytes
+// The last sequence has literals only. As LZ4 decoders require, the last 5 bytes are
+// literals, and no match starts within the last 12 bytes. Matches are found with a hash table
+// of 4 bytes words.
+
+namespace detail::lz {
+    constexpr size_t min_match  = 4;
+    constexpr size_t max_offset = 65535;
+    constexpr size_t last_literals = 5;  // Bytes which end the block as literals.
+    constexpr size_t match_limit   = 12; // Bytes before the end of the block where matches can't start.
+    constexpr unsigned hash_bits = 12;
+
+    inline uint32_t read_u32(std::byte const* ptr) noexcept {
+        uint32_t value;
+        memcpy(&value, ptr, sizeof(value));
+        return value;
+    }
+    inline uint64_t read_u64(std::byte const* ptr) noexcept {
+        uint64_t value;
+        memcpy(&value, ptr, sizeof(value));
+        return value;
+    }
+    inline uint32_t hash(uint32_t value) noexcept {
+        return (value * 2654435761u) >> (32 - hash_bits);
+    }
+
+    inline std::byte* write_length(std::byte* out, size_t length) noexcept {
+        for (; length >= 255; length -= 255) *out++ = std::byte{ 255 };
+        *out++ = static_cast<std::byte>(length);
+        return out;
+    }
+    // A null match length writes the last sequence.
+    inline std::byte* write_sequence(std::byte* out, std::byte const* literals, size_t literals_count,
+                                     size_t offset, size_t match_length) noexcept {
+        auto const match_code = match_length == 0 ? 0 : match_length - min_match;
+        auto const token = out++;
+        *token = static_cast<std::byte>((std::min<size_t>(literals_count, 15) << 4) | std::min<size_t>(match_code, 15));
+        if (literals_count >= 15) out = write_length(out, literals_count - 15);
+        if (literals_count > 0) memcpy(out, literals, literals_count);
+        out += literals_count;
+        if (match_length == 0) return out;
+
+        *out++ = static_cast<std::byte>(offset & 0xFF);
+        *out++ = static_cast<std::byte>(offset >> 8);
+        if (match_code >= 15) out = write_length(out, match_code - 15);
+        return out;
+    }
+
+    inline bool read_length(std::byte const*& in, std::byte const* end, size_t& length) noexcept {
+        for (;;) {
+            if (in == end) return false;
+            auto const byte = static_cast<size_t>(*in++);
+            length += byte;
+            if (byte != 255) return true;
+        }
+    }
+}
+
+// Maximum compressed size of size bytes.
+constexpr size_t lz_compress_bound(size_t size) noexcept {
+    return size + size / 255 + 16;
+}
+
+// Writes at most lz_compress_bound(input.size()) bytes, returns the compressed size.
+inline size_t lz_compress(span<std::byte const> input, std::byte* output) noexcept {
+    using namespace detail::lz;
+    uint32_t table[1 << hash_bits] = {};
+
+    auto const begin = input.begin();
+    auto const end   = input.end();
+    auto out    = output;
+    auto anchor = begin;
+    auto ptr    = begin;
+
+    // Misses accelerate the search, to skip incompressible data quickly.
+    size_t misses = 0;
+    auto const match_end = end - std::min(input.size(), last_literals);
+    while (input.size() >= match_limit && ptr <= end - match_limit) {
+        auto const value = read_u32(ptr);
+        auto& slot = table[hash(value)];
+        auto match = begin + slot;
+        slot = static_cast<uint32_t>(ptr - begin);
+
+        if (match >= ptr || static_cast<size_t>(ptr - match) > max_offset || read_u32(match) != value) {
+            ptr += 1 + (misses++ >> 5);
+            continue;
+        }
+        misses = 0;
+        while (ptr > anchor && match > begin && ptr[-1] == match[-1]) {
+            --ptr;
+            --match;
+        }
+        auto length = min_match;
+        while (ptr + length + 8 <= match_end && read_u64(ptr + length) == read_u64(match + length)) length += 8;
+        while (ptr + length < match_end && ptr[length] == match[length]) ++length;
+
+        out = write_sequence(out, anchor, ptr - anchor, ptr - match, length);
+        ptr += length;
+        anchor = ptr;
+    }
+    out = write_sequence(out, anchor, end - anchor, 0, 0);
+    return out - output;
+}
+
+// Fails unless the input decompresses to exactly output.size() bytes.
+inline bool lz_decompress(span<std::byte const> input, span<std::byte> output) noexcept {
+    using namespace detail::lz;
+    auto in = input.begin();
+    auto const in_end = input.end();
+    auto out = output.begin();
+    auto const out_end = output.end();
+
+    for (;;) {
+        if (in == in_end) return false;
+        auto const token = static_cast<size_t>(*in++);
+
+        size_t literals_count = token >> 4;
+        if (literals_count == 15 && !read_length(in, in_end, literals_count)) return false;
+        if (literals_count > static_cast<size_t>(in_end - in) || literals_count > static_cast<size_t>(out_end - out)) return false;
+        if (literals_count > 0) memcpy(out, in, literals_count);
+        in  += literals_count;
+        out += literals_count;
+        if (in == in_end) return out == out_end;
+
+        if (in_end - in < 2) return false;
+        auto const offset = static_cast<size_t>(in[0]) | static_cast<size_t>(in[1]) << 8;
+        in += 2;
+        if (offset == 0 || offset > static_cast<size_t>(out - output.begin())) return false;
+
+        size_t length = token & 15;
+        if (length == 15 && !read_length(in, in_end, length)) return false;
+        length += min_match;
+        if (length > static_cast<size_t>(out_end - out)) return false;
+
+        auto match = out - offset;
+        if (offset >= length) {
+            memcpy(out, match, length);
+            out += length;
+        }
+        else if (offset >= 8) {
+            auto const last = out + length;
+            for (; out + 8 <= last; out += 8, match += 8) memcpy(out, match, 8);
+            while (out < last) *out++ = *match++;
+        }
+        else {
+            for (auto const last = out + length; out < last;) *out++ = *match++;
+        }
+    }
+}
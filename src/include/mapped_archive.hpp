@@ -0,0 +1,316 @@
+#pragma once
+
+#include <lazy_reader.hpp>
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdio>
+#include <stdexcept>
+#include <system_error>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Archives are files of serialized records, read back through a memory mapping :
+//   header    : magic number, records count and directory offset, on 8 bytes each
+//   records   : each aligned on record_alignment bytes, so that views can alias their elements
+//   directory : offset and size of each record, on 8 bytes each
+// The header and the directory are written in the portable format, the records in the format
+// given to each write. Opening an archive only reads its header : the pages of a record are
+// loaded when it is read, and deserializing it into views copies nothing.
+
+namespace detail::archive {
+    constexpr uint64_t magic = 0x31484352414e4942; // "BINARCH1" in little endian.
+    constexpr size_t header_size = 3 * sizeof(uint64_t);
+    constexpr size_t record_alignment = 16;
+    constexpr size_t entry_size = 2 * sizeof(uint64_t);
+
+    constexpr uint64_t align(uint64_t offset) noexcept {
+        return (offset + record_alignment - 1) / record_alignment * record_alignment;
+    }
+
+    struct record_buffer {
+        std::vector<std::byte> bytes;
+
+        void write(void const* data, size_t size) {
+            auto const begin = static_cast<std::byte const*>(data);
+            bytes.insert(bytes.end(), begin, begin + size);
+        }
+    };
+}
+
+// How the records of a mapped archive are read, which decides how many pages the system loads
+// ahead of those read.
+enum class access_pattern {
+    normal,
+    random,    // No read ahead : only the pages read are loaded.
+    sequential // Aggressive read ahead, and pages already read may be dropped early.
+};
+
+// Appends records to a new archive file. The directory and the header are written when the
+// archive is closed : an archive which wasn't closed fails to open. Throws std::system_error
+// when the file can't be written.
+class archive_writer {
+    std::FILE* file_ = nullptr;
+    std::vector<std::pair<uint64_t, uint64_t>> directory_;
+    uint64_t offset_ = 0;
+    detail::archive::record_buffer record_;
+
+    void write_bytes(void const* data, size_t size) {
+        if (std::fwrite(data, 1, size, file_) != size) {
+            throw std::system_error{ errno, std::generic_category(), "Failed to write the archive" };
+        }
+        offset_ += size;
+    }
+    void write_padding() {
+        std::byte const zeros[detail::archive::record_alignment] = {};
+        write_bytes(zeros, static_cast<size_t>(detail::archive::align(offset_) - offset_));
+    }
+    size_t write_record() {
+        write_padding();
+        directory_.emplace_back(offset_, record_.bytes.size());
+        write_bytes(record_.bytes.data(), record_.bytes.size());
+        return directory_.size() - 1;
+    }
+public:
+    explicit archive_writer(char const* path) :
+        file_{ std::fopen(path, "wb") }
+    {
+        if (!file_) throw std::system_error{ errno, std::generic_category(), path };
+        // The header is written on close, once the directory is known.
+        std::byte const header[detail::archive::header_size] = {};
+        write_bytes(header, sizeof(header));
+    }
+    // Closes the archive if it wasn't, ignoring errors.
+    ~archive_writer() {
+        if (!file_) return;
+        try { close(); }
+        catch (...) {}
+    }
+    archive_writer(archive_writer const&) = delete;
+    archive_writer& operator=(archive_writer const&) = delete;
+
+    // Number of records written.
+    size_t size() const noexcept { return directory_.size(); }
+
+    // Writes a record, and returns its index.
+    template <class Format = native_format, class T>
+    size_t write(T const& value) {
+        record_.bytes.clear();
+        serialize<Format>(value, record_);
+        return write_record();
+    }
+    // Writes a record with its offset tables, to be read with a lazy_reader.
+    template <class Format = native_format, class T>
+    size_t write_with_tables(T const& value) {
+        record_.bytes.clear();
+        serialize_with_tables<Format>(value, record_);
+        return write_record();
+    }
+
+    // Writes the directory and the header.
+    void close() {
+        auto const file = file_;
+        try {
+            write_padding();
+            auto const directory_offset = offset_;
+            auto entry = std::array<std::byte, detail::archive::entry_size>{};
+            for (auto const& record : directory_) {
+                auto out = span<std::byte>{ entry };
+                serialize<portable_format>(record, out);
+                write_bytes(entry.data(), entry.size());
+            }
+
+            auto header = std::array<std::byte, detail::archive::header_size>{};
+            auto out = span<std::byte>{ header };
+            serialize<portable_format>(std::tuple{ detail::archive::magic, uint64_t{ directory_.size() }, directory_offset }, out);
+            if (std::fseek(file, 0, SEEK_SET) != 0) {
+                throw std::system_error{ errno, std::generic_category(), "Failed to write the archive" };
+            }
+            write_bytes(header.data(), header.size());
+        }
+        catch (...) {
+            std::fclose(file);
+            file_ = nullptr;
+            throw;
+        }
+        file_ = nullptr;
+        if (std::fclose(file) != 0) {
+            throw std::system_error{ errno, std::generic_category(), "Failed to write the archive" };
+        }
+    }
+};
+
+// Read only mapping of an archive file. Records are spans of the mapping, valid as long as the
+// archive : views deserialized from them alias the file pages. Throws std::system_error when
+// the file can't be mapped, and std::runtime_error when it isn't a closed archive.
+class mapped_archive {
+    std::byte const* data_ = nullptr;
+    size_t size_ = 0;
+    size_t records_count_ = 0;
+    size_t directory_offset_ = 0;
+
+    void unmap() noexcept {
+        if (!data_) return;
+#if defined(_WIN32)
+        UnmapViewOfFile(data_);
+#else
+        munmap(const_cast<std::byte*>(data_), size_);
+#endif
+        data_ = nullptr;
+    }
+    void map(char const* path) {
+#if defined(_WIN32)
+        auto const error = [path] { return std::system_error{ static_cast<int>(GetLastError()), std::system_category(), path }; };
+        auto const file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) throw error();
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size)) {
+            auto const e = error();
+            CloseHandle(file);
+            throw e;
+        }
+        size_ = static_cast<size_t>(size.QuadPart);
+        if (size_ < detail::archive::header_size) {
+            CloseHandle(file);
+            throw std::runtime_error{ "Not an archive" };
+        }
+        auto const mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        auto const mapping_error = error();
+        CloseHandle(file);
+        if (!mapping) throw mapping_error;
+        data_ = static_cast<std::byte const*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        auto const view_error = error();
+        CloseHandle(mapping);
+        if (!data_) throw view_error;
+#else
+        auto const error = [path] { return std::system_error{ errno, std::generic_category(), path }; };
+        auto const file = ::open(path, O_RDONLY | O_CLOEXEC);
+        if (file < 0) throw error();
+        struct stat status;
+        if (fstat(file, &status) != 0) {
+            auto const e = error();
+            ::close(file);
+            throw e;
+        }
+        size_ = static_cast<size_t>(status.st_size);
+        if (size_ < detail::archive::header_size) {
+            ::close(file);
+            throw std::runtime_error{ "Not an archive" };
+        }
+        auto const data = mmap(nullptr, size_, PROT_READ, MAP_SHARED, file, 0);
+        auto const mapping_error = error();
+        ::close(file);
+        if (data == MAP_FAILED) throw mapping_error;
+        data_ = static_cast<std::byte const*>(data);
+#endif
+    }
+    // Applies the advice to the pages of [offset, offset + size).
+    template <class Advice>
+    void advise_range(size_t offset, size_t size, Advice advice) const noexcept {
+#if defined(_WIN32)
+        (void)offset; (void)size; (void)advice;
+#else
+        // The mapping is page aligned, so only the start of the range has to be aligned.
+        auto const page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        auto const begin = offset / page * page;
+        madvise(const_cast<std::byte*>(data_) + begin, offset + size - begin, advice);
+#endif
+    }
+public:
+    explicit mapped_archive(char const* path, access_pattern pattern = access_pattern::random) {
+        map(path);
+        auto header = span<std::byte const>{ data_, detail::archive::header_size };
+        auto values = std::tuple<uint64_t, uint64_t, uint64_t>{};
+        deserialize<portable_format>(values, header);
+        auto const [magic, records_count, directory_offset] = values;
+        auto const max_count = (size_ - std::min<size_t>(size_, directory_offset)) / detail::archive::entry_size;
+        if (magic != detail::archive::magic || directory_offset > size_ || records_count > max_count) {
+            unmap();
+            throw std::runtime_error{ "Not an archive" };
+        }
+        records_count_ = static_cast<size_t>(records_count);
+        directory_offset_ = static_cast<size_t>(directory_offset);
+        advise(pattern);
+    }
+    ~mapped_archive() { unmap(); }
+
+    mapped_archive(mapped_archive&& other) noexcept :
+        data_{ std::exchange(other.data_, nullptr) },
+        size_{ other.size_ },
+        records_count_{ std::exchange(other.records_count_, 0) },
+        directory_offset_{ other.directory_offset_ }
+    {}
+    mapped_archive& operator=(mapped_archive&& other) noexcept {
+        if (this == &other) return *this;
+        unmap();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = other.size_;
+        records_count_ = std::exchange(other.records_count_, 0);
+        directory_offset_ = other.directory_offset_;
+        return *this;
+    }
+
+    // Number of records.
+    size_t size() const noexcept { return records_count_; }
+
+    // Bytes of a record. Records out of the archive, or whose entry is corrupted, are empty.
+    span<std::byte const> record(size_t index) const noexcept {
+        if (index >= records_count_) return {};
+        auto entry = span<std::byte const>{ data_ + directory_offset_ + index * detail::archive::entry_size, detail::archive::entry_size };
+        auto bounds = std::pair<uint64_t, uint64_t>{};
+        deserialize<portable_format>(bounds, entry);
+        auto const [offset, size] = bounds;
+        if (offset > directory_offset_ || size > directory_offset_ - offset) return {};
+        return { data_ + offset, static_cast<size_t>(size) };
+    }
+
+    // Deserializes a record, checking its bounds like try_deserialize.
+    template <class Format = native_format, class T>
+    bool try_read(size_t index, T& value) const {
+        auto in = record(index);
+        return try_deserialize<Format>(value, in);
+    }
+    // Reads a record written with write_with_tables on demand.
+    template <class T, class Format = native_format>
+    lazy_reader<T, Format> reader(size_t index) const noexcept {
+        return lazy_reader<T, Format>{ record(index) };
+    }
+
+    // Sets the read ahead of the whole archive.
+    void advise(access_pattern pattern) const noexcept {
+#if !defined(_WIN32)
+        auto const advice = pattern == access_pattern::random ? MADV_RANDOM
+                          : pattern == access_pattern::sequential ? MADV_SEQUENTIAL : MADV_NORMAL;
+        advise_range(0, size_, advice);
+#else
+        (void)pattern;
+#endif
+    }
+    // Asks the system to load the pages of the records of [first, first + count) ahead of their read.
+    void prefetch(size_t first, size_t count) const noexcept {
+        if (first >= records_count_ || count == 0) return;
+        auto const last = std::min(records_count_, first + count) - 1;
+        auto const begin = record(first);
+        auto const end = record(last);
+        if (begin.data() == nullptr || end.data() < begin.data()) return;
+#if !defined(_WIN32)
+        advise_range(static_cast<size_t>(begin.data() - data_), static_cast<size_t>(end.end() - begin.data()), MADV_WILLNEED);
+#endif
+    }
+};
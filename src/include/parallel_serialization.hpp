@@ -0,0 +1,199 @@
+#pragma once
+
+#include <serialization.hpp>
+#include <thread_pool.hpp>
+#include <exception>
+#include <iterator>
+#include <vector>
+
+// Large ranges are serialized by chunks of elements on a thread pool : the size of each chunk
+// is computed first, and their prefix sum gives where each chunk is written. The bytes are the
+// same as with serialize.
+// Dynamic arrays written with an index (see range_index) are deserialized by blocks on a thread
+// pool, each block being decoded from its own slice of the buffer into a new array, which is
+// moved into the value once every block is decoded.
+
+namespace detail::parallel {
+    // Ranges smaller than that are serialized on the calling thread.
+    constexpr size_t min_chunk_size = 256;
+
+    // Chunks per thread, so that the threads which end first take the remaining chunks.
+    constexpr size_t chunks_per_thread = 4;
+
+    template <class T>
+    constexpr bool is_parallel_range() noexcept {
+        constexpr auto category = serialization_category_v<T>;
+        return category == serialization_category::container
+            || category == serialization_category::fixed_array
+            || category == serialization_category::dynamic_array;
+    }
+
+    // Iterators to the first element of each chunk, and to the end of the range.
+    template <class T>
+    auto get_chunk_bounds(T const& range, size_t count, size_t chunk_size) {
+        using traits = range_traits<T>;
+        auto bounds = std::vector<decltype(traits::begin(range))>{};
+        bounds.reserve(count / chunk_size + 2);
+
+        auto it = traits::begin(range);
+        for (size_t i = 0; i < count; i += chunk_size) {
+            bounds.push_back(it);
+            std::advance(it, std::min(chunk_size, count - i));
+        }
+        bounds.push_back(traits::end(range));
+        return bounds;
+    }
+
+    // Indexed ranges are written by the blocks of their index.
+    template <class Format, class T>
+    bool serialize_range(T const& range, span<std::byte>& buffer, thread_pool& pool) {
+        using traits = range_traits<T>;
+        using value_type = typename traits::value_type;
+        auto const count = static_cast<size_t>(traits::size(range));
+        auto const is_indexed = has_range_index<T, Format>(count);
+
+        // The sizes pass only pays off when the chunks are written concurrently.
+        auto const chunks_target = pool.size() * chunks_per_thread;
+        auto const chunk_size = is_indexed ? range_index_stride : std::max(min_chunk_size, (count + chunks_target - 1) / chunks_target);
+        if (pool.size() < 2 || count <= chunk_size) {
+            return try_serialize<Format>(range, buffer);
+        }
+        auto const bounds = get_chunk_bounds(range, count, chunk_size);
+        auto const chunks_count = bounds.size() - 1;
+
+        auto sizes = std::vector<size_t>(chunks_count);
+        if constexpr (has_static_serialized_size_v<value_type, Format>) {
+            for (size_t i = 0; i < chunks_count; ++i) {
+                sizes[i] = static_cast<size_t>(std::distance(bounds[i], bounds[i + 1])) * serialized_size_v<value_type, Format>;
+            }
+        }
+        else {
+            pool.run(chunks_count, [&] (size_t i) {
+                for (auto it = bounds[i]; it != bounds[i + 1]; ++it) sizes[i] += get_serialized_size<Format>(*it);
+            });
+        }
+
+        // Offsets of the chunks, relatively to the first element.
+        auto offsets = std::vector<size_t>(chunks_count + 1);
+        for (size_t i = 0; i < chunks_count; ++i) offsets[i + 1] = offsets[i] + sizes[i];
+        auto const elements_size = offsets.back();
+
+        size_t size = elements_size;
+        if constexpr (serialization_category_v<T> != serialization_category::fixed_array) {
+            size += get_serialized_size_size<Format>(count);
+        }
+        if (is_indexed) {
+            size += get_serialized_size_size<Format>(elements_size);
+            for (size_t i = 0; i + 1 < chunks_count; ++i) size += get_serialized_size_size<Format>(sizes[i]);
+        }
+        if (size > buffer.size()) return false;
+
+        if constexpr (serialization_category_v<T> != serialization_category::fixed_array) {
+            serialize_size<Format, false>(count, buffer);
+        }
+        if (is_indexed) serialize_size<Format, false>(elements_size, buffer);
+        auto const elements = buffer.data();
+        pool.run(chunks_count, [&] (size_t i) {
+            auto out = span<std::byte>{ elements + offsets[i], elements + offsets[i + 1] };
+            for (auto it = bounds[i]; it != bounds[i + 1]; ++it) serialize_value<Format, false>(*it, out);
+        });
+        buffer.begin() += elements_size;
+        if (is_indexed) {
+            for (size_t i = 0; i + 1 < chunks_count; ++i) serialize_size<Format, false>(sizes[i], buffer);
+        }
+        return true;
+    }
+
+    // Reads the offsets of the blocks of an indexed range, relatively to its first element.
+    template <class Format>
+    bool deserialize_block_offsets(std::vector<size_t>& offsets, size_t elements_size, span<std::byte const>& buffer) {
+        for (size_t i = 1; i + 1 < offsets.size(); ++i) {
+            size_t block_size;
+            if (!deserialize_size<Format, true>(block_size, buffer)) return false;
+            if (block_size > elements_size - offsets[i - 1]) return false;
+            offsets[i] = offsets[i - 1] + block_size;
+        }
+        offsets.back() = elements_size;
+        return true;
+    }
+
+    template <class Format, class T>
+    bool deserialize_array(T& array, span<std::byte const>& buffer, thread_pool& pool) {
+        using value_type = typename range_traits<T>::value_type;
+        auto in = buffer;
+
+        size_t count;
+        if (!deserialize_size<Format, true>(count, in)) return false;
+        if (pool.size() < 2 || !has_range_index<T, Format>(count)) {
+            return try_deserialize<Format>(array, buffer);
+        }
+        size_t elements_size;
+        if (!deserialize_size<Format, true>(elements_size, in) || in.size() < elements_size) return false;
+        if (!is_possible_count<value_type, Format, true>(count, in)) return false;
+
+        auto const elements = in.data();
+        in.begin() += elements_size;
+        auto offsets = std::vector<size_t>(get_blocks_count(count) + 1);
+        if (!deserialize_block_offsets<Format>(offsets, elements_size, in)) return false;
+
+        // Blocks are decoded into a temporary array, so that the array is untouched on failure.
+        auto result = T{};
+        dynamic_array_traits<T>::resize(result, count);
+        auto const values = array_traits<T>::data(result);
+        auto successes = std::vector<char>(offsets.size() - 1);
+        auto errors = std::vector<std::exception_ptr>(offsets.size() - 1);
+        pool.run(successes.size(), [&] (size_t i) {
+            try {
+                auto block = span<std::byte const>{ elements + offsets[i], elements + offsets[i + 1] };
+                auto const first = values + i * range_index_stride;
+                auto const last  = values + std::min(count, (i + 1) * range_index_stride);
+                auto success = true;
+                for (auto it = first; success && it != last; ++it) success = deserialize_value<Format, true>(*it, block);
+                successes[i] = success && block.size() == 0;
+            }
+            catch (...) {
+                errors[i] = std::current_exception();
+            }
+        });
+        for (auto& error : errors) {
+            if (error) std::rethrow_exception(error);
+        }
+        if (std::find(successes.begin(), successes.end(), 0) != successes.end()) return false;
+        array = std::move(result);
+        buffer = in;
+        return true;
+    }
+}
+
+// Serializes a container, or a fixed or dynamic array, with its elements written in parallel.
+// Other values are serialized on the calling thread. Fails without moving the buffer when it
+// is too small.
+template <class Format = native_format, class T, class Buffer>
+bool parallel_serialize(T const& value, Buffer& buffer, thread_pool& pool) {
+    static_assert(is_span_buffer_v<Buffer>, "Elements are written in place, in a span buffer");
+    static_assert(Format::strings != string_encoding::interned, "Interned strings must be written in order");
+    auto& out = static_cast<span<std::byte>&>(buffer);
+
+    if constexpr (detail::parallel::is_parallel_range<T>()) {
+        return detail::parallel::serialize_range<Format>(value, out, pool);
+    }
+    else {
+        return try_serialize<Format>(value, out);
+    }
+}
+
+// Deserializes an indexed dynamic array with its blocks decoded in parallel, checking the
+// buffer bounds like try_deserialize : on failure, the buffer and the value are left untouched.
+// Ranges without an index and other values are deserialized on the calling thread. Exceptions
+// thrown while decoding a block are rethrown.
+template <class Format = native_format, class T, class Buffer>
+bool parallel_deserialize(T& value, Buffer& buffer, thread_pool& pool) {
+    static_assert(is_span_source_v<Buffer>, "Blocks are decoded from their slice of a span buffer");
+
+    if constexpr (serialization_category_v<T> == serialization_category::dynamic_array) {
+        return detail::parallel::deserialize_array<Format>(value, static_cast<span<std::byte const>&>(buffer), pool);
+    }
+    else {
+        return try_deserialize<Format>(value, buffer);
+    }
+}
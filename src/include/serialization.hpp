@@ -2,23 +2,89 @@
 #pragma once
 
 #include <aggregate_traits.hpp>
-#include <span.hpp>
+#include <byte_order.hpp>
+#include <delta_codec.hpp>
+#include <format.hpp>
+#include <value_range.hpp>
+#include <varint.hpp>
+#include <xor_codec.hpp>
 #include <algorithm>
 #include <array>
 #include <cstring>
+#include <new>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
 
 enum class serialization_category {
     forbidden,
     trivial,
+    bit_packed,
     trivial_array,
+    view,
     fixed_array,
     dynamic_array,
+    columnar_array,
+    encoded_array,
     container,
     tuple,
+    optional,
+    variant,
     aggregate,
     unknown,
 };
 
+// Views are serialized like arrays, and deserialized without copy by aliasing the buffer :
+// it must outlive them, and must be contiguous. Deserializing span<T const> also requires
+// the elements to be aligned in the buffer, otherwise it fails.
+template <class T>
+constexpr bool is_view_v = false;
+template <class Char, class Traits>
+constexpr bool is_view_v<std::basic_string_view<Char, Traits>> = true;
+template <class T>
+constexpr bool is_view_v<span<T>> = true;
+
+// Optionals and variants are written as their discriminant, on the smallest unsigned integer
+// holding it, followed by their active alternative only. Valueless variants can't be serialized.
+template <class T>
+constexpr bool is_optional_v = false;
+template <class T>
+constexpr bool is_optional_v<std::optional<T>> = true;
+template <class T>
+constexpr bool is_variant_v = false;
+template <class...Ts>
+constexpr bool is_variant_v<std::variant<Ts...>> = true;
+
+namespace detail {
+    template <class Variant>
+    using variant_index_t = std::conditional_t<(std::variant_size_v<Variant> <= 256), uint8_t, uint16_t>;
+}
+
+// Dynamic arrays of aggregates marked as columnar are serialized column by column : the first
+// field of all the elements, then the second field of all the elements, and so on. Columns of
+// trivial fields are contiguous, which helps compression and vectorized decoding.
+template <class T>
+constexpr bool is_columnar_v = false;
+
+// Dynamic arrays with a codec have their elements encoded by it, after their count and the
+// size of the encoded bytes. Select a codec by specializing array_codec for the array type :
+//   template <> struct array_codec<std::vector<int64_t>> { using type = delta_codec; };
+// A codec provides, for the element types it supports :
+//   size_t get_encoded_size<T>(T const* values, size_t count)
+//   void   encode<T>(T const* values, size_t count, std::byte* data)
+//   bool   decode<T>(T* values, size_t count, span<std::byte const> data)
+//   bool   validate<T>(size_t count, span<std::byte const> data)
+//   bool   is_possible_count(size_t count, size_t size)
+// Decoding and validating fail unless the data holds exactly count values.
+template <class Array>
+struct array_codec {
+    using type = void;
+};
+template <class Array>
+using array_codec_t = typename array_codec<Array>::type;
+
 namespace detail::no_adl {
     template <class T>
     constexpr bool has_std_get() noexcept {
@@ -29,17 +95,134 @@ namespace detail::no_adl {
     }
 }
 
+namespace detail {
+    template <class T>
+    constexpr bool contains_uncopyable() noexcept;
+
+    // Aggregates are probed with wildcards rather than destructured, to keep accepting the
+    // trivially copyable ones which contain unions.
+    struct non_union_wildcard {
+        template <class T, class = std::enable_if_t<!std::is_union_v<T>>>
+        operator T() const;
+    };
+    // Only initializes the fields which prevent a copy, and not through converting constructors
+    // such as the one of std::optional, which accepts any wildcard convertible to its value.
+    struct uncopyable_wildcard {
+        template <class T, class = std::enable_if_t<contains_uncopyable<T>()>>
+        operator T() const;
+    };
+    template <class Wildcard, size_t>
+    using wildcard_t = Wildcard;
+
+    template <class T, class Wildcard, class Sequence, class SFINAE = void>
+    constexpr bool is_brace_constructible_with_v = false;
+    template <class T, class Wildcard, size_t...Is>
+    constexpr bool is_brace_constructible_with_v<T, Wildcard, std::index_sequence<Is...>, std::void_t<decltype(
+        T{ wildcard_t<Wildcard, Is>{}... }
+    )>> = true;
+
+    template <class T, class SFINAE, class...Wildcards>
+    constexpr bool is_brace_constructible_from_v = false;
+    template <class T, class...Wildcards>
+    constexpr bool is_brace_constructible_from_v<T, std::void_t<decltype(
+        T{ Wildcards{}... }
+    )>, Wildcards...> = true;
+
+    template <class T, size_t...Is>
+    constexpr bool has_uncopyable_field(std::index_sequence<Is...>) noexcept {
+        constexpr auto probe = [] (auto field) {
+            return is_brace_constructible_from_v<T, void,
+                std::conditional_t<Is == decltype(field)::value, uncopyable_wildcard, non_union_wildcard>...>;
+        };
+        return (probe(std::integral_constant<size_t, Is>{}) || ...);
+    }
+
+    template <class T, size_t N = 0>
+    constexpr size_t get_initializers_count() noexcept {
+        if constexpr (N <= max_arity && is_brace_constructible_with_v<T, non_union_wildcard, std::make_index_sequence<N + 1>>) {
+            return get_initializers_count<T, N + 1>();
+        }
+        else {
+            return N;
+        }
+    }
+
+    // Views, bit packed values, optionals and variants inside trivially copyable types prevent
+    // them to be copied as is. Members of trivially copyable types are trivially copyable too.
+    template <class T>
+    constexpr bool contains_uncopyable() noexcept {
+        if constexpr (is_view_v<T> || is_bit_packed_v<T> || is_optional_v<T> || is_variant_v<T>) {
+            return true;
+        }
+        else if constexpr (!std::is_class_v<T>) {
+            return false;
+        }
+        else if constexpr (is_array_v<T>) {
+            return contains_uncopyable<typename array_traits<T>::value_type>();
+        }
+        else if constexpr (no_adl::has_std_get<T>() && no_adl::has_fixed_size<T>()) {
+            return std::apply([] (auto...tags) {
+                return (contains_uncopyable<remove_cvref_t<typename decltype(tags)::type>>() || ...);
+            }, map_tuple_types_t<T, tag_type>{});
+        }
+        else if constexpr (std::is_aggregate_v<T>) {
+            // Aggregates with more members than as_tuple supports are copied as is.
+            constexpr auto count = get_initializers_count<T>();
+            if constexpr (count > max_arity) {
+                return false;
+            }
+            else {
+                return has_uncopyable_field<T>(std::make_index_sequence<count>{});
+            }
+        }
+        else {
+            return false;
+        }
+    }
+
+    template <class T>
+    constexpr bool is_trivially_serializable() noexcept {
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            return !contains_uncopyable<T>();
+        }
+        else {
+            return false;
+        }
+    }
+}
+
 namespace detail {
     template <class T>
     constexpr serialization_category get_serialization_category() {
         if constexpr (std::is_pointer_v<T> || std::is_array_v<T>) {
             return serialization_category::forbidden;
         }
-        else if constexpr (std::is_trivially_copyable_v<T>) {
+        else if constexpr (is_view_v<T>) {
+            return serialization_category::view;
+        }
+        else if constexpr (is_bit_packed_v<T>) {
+            return serialization_category::bit_packed;
+        }
+        else if constexpr (is_optional_v<T>) {
+            return serialization_category::optional;
+        }
+        else if constexpr (is_variant_v<T>) {
+            return serialization_category::variant;
+        }
+        else if constexpr (is_trivially_serializable<T>()) {
             return serialization_category::trivial;
         }
         else if constexpr (is_array_v<T>) {
-            if constexpr (std::is_trivially_copyable_v<typename array_traits<T>::value_type>) {
+            using value_type = typename array_traits<T>::value_type;
+            if constexpr (!std::is_void_v<array_codec_t<T>>) {
+                static_assert(is_dynamic_array_v<T>, "Only dynamic arrays can be encoded");
+                return serialization_category::encoded_array;
+            }
+            else if constexpr (is_dynamic_array_v<T> && is_columnar_v<value_type>) {
+                static_assert(is_aggregate_v<value_type>, "Only aggregates can be serialized in columns");
+                return serialization_category::columnar_array;
+            }
+            else if constexpr (is_trivially_serializable<value_type>()) {
                 static_assert(is_dynamic_array_v<T>);
                 return serialization_category::trivial_array;
             }
@@ -71,314 +254,2398 @@ constexpr auto serialization_category_v = detail::get_serialization_category<rem
 template <class T>
 using serialization_category_tag_t = value_tag<serialization_category_v<T>>;
 
+template <class Buffer>
+constexpr bool is_span_buffer_v = std::is_convertible_v<Buffer&, span<std::byte>&>;
+template <class Buffer>
+constexpr bool is_span_source_v = std::is_convertible_v<Buffer&, span<std::byte const>&>;
+
 // functions
 
-template <class T>
-void serialize(T const& value, span<std::byte>& buffer) noexcept;
+// The buffer is either a span<std::byte>, or a growable buffer with a 'write(data, size)' method.
+template <class Format = native_format, class T, class Buffer>
+void serialize(T const& value, Buffer& buffer) noexcept(is_span_buffer_v<Buffer>);
 
-template <class T>
-void deserialize(T& value, span<std::byte const>& buffer);
+// Checks the buffer bounds while serializing. On failure, the buffer is left untouched.
+// The buffer is a span<std::byte>.
+template <class Format = native_format, class T, class Buffer>
+bool try_serialize(T const& value, Buffer& buffer) noexcept;
 
-template <class T>
+// The buffer is either a span<std::byte const>, or a source with 'read(data, size)' and 'size()' methods
+// which is cheap to copy. Sources whose 'read' returns a bool fail the reads when it is false.
+template <class Format = native_format, class T, class Buffer>
+void deserialize(T& value, Buffer& buffer);
+
+// Checks the buffer bounds while deserializing. On failure, the buffer and the value are left
+// untouched, unless the value can't be default constructed and move assigned : it is then in a
+// valid but unspecified state.
+template <class Format = native_format, class T, class Buffer>
+bool try_deserialize(T& value, Buffer& buffer);
+
+// Returns the deserialized value. Aggregates and pairs which can't be default constructed or
+// have const members are built in place from their deserialized fields.
+template <class T, class Format = native_format, class Buffer>
+T deserialize(Buffer& buffer);
+
+template <class Format = native_format, class T>
 constexpr size_t get_serialized_size(T const& value) noexcept;
 
-template <class T>
+template <class T, class Format = native_format>
 std::pair<size_t, bool> try_get_deserialized_size(span<std::byte const> buffer) noexcept;
 
-// serialize
+// Serializes a value of static size into a stack buffer which always fits it, without bounds checks.
+template <class Format = native_format, class T>
+auto serialize_to_array(T const& value) noexcept;
 
 namespace detail {
-    template <class T, serialization_category Category>
-    void do_serialize(T const&, span<std::byte>&, value_tag<Category>) noexcept {
-        static_assert(serialization_category_v<T> != serialization_category::forbidden);
-        static_assert(serialization_category_v<T> != serialization_category::unknown);
+    template <class Format, bool Checked, class T, class Buffer>
+    bool serialize_value(T const& value, Buffer& buffer);
+    template <class Format, bool Checked, class T, class Buffer>
+    bool deserialize_value(T& value, Buffer& buffer);
+    template <class Format, class T>
+    constexpr size_t get_range_size(T const& range) noexcept;
+}
+
+// raw bytes
+
+namespace detail {
+    template <bool Checked, class Buffer>
+    bool write_bytes(void const* data, size_t size, Buffer& buffer) {
+        if constexpr (is_span_buffer_v<Buffer>) {
+            if constexpr (Checked) {
+                if (buffer.size() < size) return false;
+            }
+            memcpy(buffer.data(), data, size);
+            buffer.begin() += size;
+        }
+        else {
+            static_assert(!Checked, "Only span buffers can be checked");
+            buffer.write(data, size);
+        }
+        return true;
+    }
+    // Sources may fail to read data which they can't restore, such as corrupted compressed blocks.
+    template <class Buffer>
+    bool read_source(void* data, size_t size, Buffer& buffer) {
+        if constexpr (std::is_same_v<decltype(buffer.read(data, size)), bool>) {
+            return buffer.read(data, size);
+        }
+        else {
+            buffer.read(data, size);
+            return true;
+        }
+    }
+
+    template <bool Checked, class Buffer>
+    bool read_bytes(void* data, size_t size, Buffer& buffer) {
+        if constexpr (Checked) {
+            if (buffer.size() < size) return false;
+        }
+        if constexpr (is_span_source_v<Buffer>) {
+            memcpy(data, buffer.data(), size);
+            buffer.begin() += size;
+        }
+        else if (!read_source(data, size, buffer)) {
+            return false;
+        }
+        return true;
+    }
+    // Returns a pointer to the next bytes, or nullptr if they are misaligned or not contiguous.
+    template <bool Checked, class Buffer>
+    std::byte const* read_view(size_t size, size_t alignment, Buffer& buffer) noexcept {
+        if constexpr (Checked) {
+            if (buffer.size() < size) return nullptr;
+        }
+        if constexpr (is_span_source_v<Buffer>) {
+            auto const data = buffer.data();
+            if (reinterpret_cast<uintptr_t>(data) % alignment != 0) return nullptr;
+            buffer.begin() += size;
+            return data;
+        }
+        else {
+            return buffer.read_view(size, alignment);
+        }
+    }
+}
+
+// range sizes
+
+namespace detail {
+    template <class Format, bool Checked, class Buffer>
+    bool serialize_size(size_t size, Buffer& buffer) {
+        if constexpr (Format::sizes == size_encoding::varint && is_span_buffer_v<Buffer>) {
+            if constexpr (Checked) {
+                if (buffer.size() < max_varint_size && buffer.size() < get_varint_size(size)) return false;
+            }
+            write_varint(size, buffer);
+            return true;
+        }
+        else if constexpr (Format::sizes == size_encoding::varint) {
+            std::byte bytes[max_varint_size];
+            auto varint = span<std::byte>{ bytes, max_varint_size };
+            write_varint(size, varint);
+            return write_bytes<Checked>(bytes, varint.data() - bytes, buffer);
+        }
+        else if constexpr (Format::sizes == size_encoding::fixed64) {
+            auto value = static_cast<uint64_t>(size);
+            if constexpr (is_foreign_order_v<Format>) value = byte_swap::swap_word(value);
+            return write_bytes<Checked>(&value, sizeof(value), buffer);
+        }
+        else {
+            return write_bytes<Checked>(&size, sizeof(size), buffer);
+        }
+    }
+    // When checked, a span buffer is only advanced on success.
+    template <class Format, bool Checked, class Buffer>
+    bool deserialize_size(size_t& size, Buffer& buffer) {
+        if constexpr (Format::sizes == size_encoding::varint && is_span_source_v<Buffer>) {
+            if constexpr (Checked) {
+                uint64_t value;
+                if (!try_read_varint(value, buffer) || value > SIZE_MAX) return false;
+                size = static_cast<size_t>(value);
+            }
+            else {
+                size = static_cast<size_t>(read_varint(buffer));
+            }
+            return true;
+        }
+        else if constexpr (Format::sizes == size_encoding::varint) {
+            uint64_t value = 0;
+            for (size_t i = 0; i < max_varint_size; ++i) {
+                std::byte byte;
+                if (!read_bytes<Checked>(&byte, 1, buffer)) return false;
+
+                auto const bits = static_cast<uint64_t>(byte);
+                if (Checked && i == max_varint_size - 1 && bits > 1) return false;
+                value |= (bits & 0x7F) << (7 * i);
+                if (bits < 0x80) break;
+            }
+            if (Checked && value > SIZE_MAX) return false;
+            size = static_cast<size_t>(value);
+            return true;
+        }
+        else if constexpr (Format::sizes == size_encoding::fixed64) {
+            uint64_t value;
+            if (!read_bytes<Checked>(&value, sizeof(value), buffer)) return false;
+            if constexpr (is_foreign_order_v<Format>) value = byte_swap::swap_word(value);
+            if (Checked && value > SIZE_MAX) return false;
+            size = static_cast<size_t>(value);
+            return true;
+        }
+        else {
+            return read_bytes<Checked>(&size, sizeof(size), buffer);
+        }
+    }
+    template <class Format>
+    constexpr size_t get_serialized_size_size(size_t size) noexcept {
+        if constexpr (Format::sizes == size_encoding::varint) {
+            return get_varint_size(size);
+        }
+        else if constexpr (Format::sizes == size_encoding::fixed64) {
+            return sizeof(uint64_t);
+        }
+        else {
+            return sizeof(size);
+        }
+    }
+
+    // Only containers and dynamic arrays are indexed, when they have several blocks.
+    template <class T, class Format>
+    constexpr bool has_range_index(size_t count) noexcept {
+        static_assert(Format::ranges == range_index::none || Format::strings != string_encoding::interned,
+                      "Interned strings have no size before they are written, so ranges of them can't be indexed");
+        constexpr auto category = serialization_category_v<T>;
+        constexpr auto is_indexable = category == serialization_category::container
+                                   || category == serialization_category::dynamic_array;
+        return is_indexable && Format::ranges == range_index::blocks && count > range_index_stride;
+    }
+    constexpr size_t get_blocks_count(size_t count) noexcept {
+        return (count + range_index_stride - 1) / range_index_stride;
+    }
+}
+
+// interned strings
+
+namespace detail {
+    template <class Buffer>
+    constexpr bool has_string_dictionary() noexcept {
+        constexpr auto expr = [] (auto&& buffer) -> decltype(
+            buffer.strings()
+        ) {};
+        return std::is_invocable_v<decltype(expr), Buffer&>;
+    }
+    template <class Buffer>
+    size_t get_strings_count(Buffer const& buffer) noexcept {
+        if constexpr (has_string_dictionary<Buffer>()) return buffer.strings().size();
+        else return 0;
+    }
+    // Rolls the dictionary back after a failed checked operation.
+    template <class Buffer>
+    void forget_strings(Buffer& buffer, size_t count) {
+        if constexpr (has_string_dictionary<Buffer>()) buffer.strings().truncate(count);
     }
+
+    // The size prefix of interned strings is doubled : odd ones are the index of a previous string.
+    template <class T, class Format>
+    constexpr bool is_interned() noexcept {
+        return Format::strings == string_encoding::interned
+            && (std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view>);
+    }
+
+    template <class Format, bool Checked, class Buffer>
+    bool serialize_interned(std::string_view str, Buffer& buffer) {
+        static_assert(is_span_buffer_v<Buffer> && has_string_dictionary<Buffer>(),
+            "Interned strings are written to a span buffer with a string dictionary");
+        auto& strings = buffer.strings();
+        auto const index = strings.find(str);
+        if (index != strings.size()) return serialize_size<Format, Checked>(2 * index + 1, buffer);
+
+        if (!serialize_size<Format, Checked>(2 * str.size(), buffer)) return false;
+        auto const data = reinterpret_cast<char const*>(buffer.data());
+        if (!write_bytes<Checked>(str.data(), str.size(), buffer)) return false;
+        strings.intern({ data, str.size() });
+        return true;
+    }
+    template <class Format, bool Checked, class T, class Buffer>
+    bool deserialize_interned(T& str, Buffer& buffer) {
+        static_assert(is_span_source_v<Buffer> && has_string_dictionary<Buffer>(),
+            "Interned strings are read from a span buffer with a string dictionary");
+        size_t tag;
+        if (!deserialize_size<Format, Checked>(tag, buffer)) return false;
+
+        auto& strings = buffer.strings();
+        auto view = std::string_view{};
+        if (tag % 2 == 1) {
+            if (Checked && tag / 2 >= strings.size()) return false;
+            view = strings[tag / 2];
+        }
+        else {
+            auto const size = tag / 2;
+            if (Checked && buffer.size() < size) return false;
+            view = { reinterpret_cast<char const*>(buffer.data()), size };
+            buffer.begin() += size;
+            strings.intern(view);
+        }
+        if constexpr (std::is_same_v<T, std::string_view>) str = view;
+        else str.assign(view.data(), view.size());
+        return true;
+    }
+    // References can't be resolved without the dictionary, so they are not checked.
+    template <class Format>
+    std::pair<size_t, bool> try_get_interned_size(span<std::byte const> buffer) noexcept {
+        auto const data_begin = buffer.begin();
+        size_t tag;
+        if (!deserialize_size<Format, true>(tag, buffer)) return { {}, false };
+        if (tag % 2 == 1) return { buffer.begin() - data_begin, true };
+
+        auto const size = tag / 2;
+        return { buffer.begin() + size - data_begin, buffer.size() >= size };
+    }
+}
+
+// packed layouts
+
+namespace detail {
+    // Braced wildcards initialize one member each, without eliding braces into C arrays or unions.
+    template <class T, class Wildcard, class Sequence, class SFINAE = void>
+    constexpr bool is_member_wise_constructible_with_v = false;
+    template <class T, class Wildcard, size_t...Is>
+    constexpr bool is_member_wise_constructible_with_v<T, Wildcard, std::index_sequence<Is...>, std::void_t<decltype(
+        T{ { wildcard_t<Wildcard, Is>{} }... }
+    )>> = true;
+
+    template <class T, size_t N = 0>
+    constexpr size_t get_members_count() noexcept {
+        if constexpr (N <= max_arity && is_member_wise_constructible_with_v<T, non_union_wildcard, std::make_index_sequence<N + 1>>) {
+            return get_members_count<T, N + 1>();
+        }
+        else {
+            return N;
+        }
+    }
+
+    // Checks the field offsets computed for the Count fields of T against its size.
+    template <class T, size_t Count>
+    constexpr bool matches_layout() noexcept {
+        if constexpr (Count == 0) {
+            return false;
+        }
+        else {
+            using last_field = std::tuple_element_t<Count - 1, field_types_t<T, Count>>;
+            constexpr auto end = field_offsets_v<T, Count>[Count - 1] + sizeof(last_field);
+            return align_up(end, alignof(T)) == sizeof(T);
+        }
+    }
+
+    // Aggregates whose fields can be destructured and whose layout can be computed.
+    // A C array member gives different initializers and members counts.
+    template <class T>
+    constexpr bool has_computable_layout() noexcept {
+        if constexpr (!std::is_aggregate_v<T> || std::is_union_v<T> || is_range_v<T> || !std::is_standard_layout_v<T>) {
+            return false;
+        }
+        else {
+            constexpr auto count = get_members_count<T>();
+            if constexpr (count > max_arity || count != get_initializers_count<T>()) {
+                return false;
+            }
+            else {
+                return matches_layout<T, count>();
+            }
+        }
+    }
+
+    // Computed offsets ignore the fields declared with alignas : they are checked once against
+    // the addresses of the fields of a value, and types whose fields lie elsewhere are processed
+    // field by field.
     template <class T>
-    void do_serialize(T const& value, span<std::byte>& buffer, value_tag<serialization_category::trivial>) noexcept {
-        memcpy(buffer.data(), &value, sizeof(T));
-        buffer.begin() += sizeof(T);
+    bool has_computed_layout(T const& value) noexcept;
+
+    template <class T, size_t Count, size_t...Is>
+    bool check_field_offsets(T const& value, std::index_sequence<Is...>) noexcept {
+        constexpr auto offsets = field_offsets_v<T, Count>;
+        auto const fields = as_tuple(value);
+        auto const bytes  = reinterpret_cast<std::byte const*>(&value);
+        return ((reinterpret_cast<std::byte const*>(&std::get<Is>(fields)) == bytes + offsets[Is]
+              && has_computed_layout(std::get<Is>(fields))) && ...);
+    }
+    // Checks the offsets of the Count first fields of T, and the layout of these fields.
+    template <class T, size_t Count>
+    bool has_computed_offsets(T const& value) noexcept {
+        static bool const matches = check_field_offsets<T, Count>(value, std::make_index_sequence<Count>{});
+        return matches;
     }
+    // Only the layout of trivially copyable values is used to copy them.
     template <class T>
-    void do_serialize(T const& array, span<std::byte>& buffer, value_tag<serialization_category::trivial_array>) noexcept {
-        using traits = array_traits<T>;
-        serialize(traits::size(array), buffer);
+    bool has_computed_layout(T const& value) noexcept {
+        if constexpr (!std::is_trivially_copyable_v<T>) {
+            return true;
+        }
+        else if constexpr (is_range_v<T> && no_adl::has_fixed_size<T>()) {
+            if constexpr (get_fixed_size<T>() > 0) return has_computed_layout(*range_traits<T>::begin(value));
+            else return true;
+        }
+        else if constexpr (has_computable_layout<T>()) {
+            return has_computed_offsets<T, get_members_count<T>()>(value);
+        }
+        else {
+            return true;
+        }
+    }
+
+    template <class T>
+    constexpr size_t get_packed_size() noexcept;
 
-        auto const elements_size = traits::size(array) * sizeof(typename traits::value_type);
-        memcpy(buffer.data(), traits::data(array), elements_size);
-        buffer.begin() += elements_size;
+    template <class T, size_t...Is>
+    constexpr size_t get_fields_packed_size(std::index_sequence<Is...>) noexcept {
+        using fields = field_types_t<T, sizeof...(Is)>;
+        return (get_packed_size<std::tuple_element_t<Is, fields>>() + ... + 0);
     }
 
+    // Trivially copyable aggregates with padding, and fixed size arrays of them.
     template <class T>
-    void serialize_range(T const& range, span<std::byte>& buffer) noexcept {
-        using traits = range_traits<T>;
-        std::for_each(traits::begin(range), traits::end(range), [&] (auto& val) {
-            serialize(val, buffer);
-        });
+    constexpr bool is_packable() noexcept {
+        if constexpr (is_range_v<T>) {
+            if constexpr (no_adl::has_fixed_size<T>()) {
+                return is_packable<typename range_traits<T>::value_type>();
+            }
+            else {
+                return false;
+            }
+        }
+        else if constexpr (has_computable_layout<T>()) {
+            return get_packed_size<T>() < sizeof(T);
+        }
+        else {
+            return false;
+        }
+    }
+
+    // Equals sizeof(T) for types which aren't packable.
+    template <class T>
+    constexpr size_t get_packed_size() noexcept {
+        if constexpr (is_range_v<T> && no_adl::has_fixed_size<T>()) {
+            return get_fixed_size<T>() * get_packed_size<typename range_traits<T>::value_type>();
+        }
+        else if constexpr (has_computable_layout<T>()) {
+            return get_fields_packed_size<T>(std::make_index_sequence<get_members_count<T>()>{});
+        }
+        else {
+            return sizeof(T);
+        }
     }
 
+    template <class T, class Format>
+    constexpr bool is_packed() noexcept {
+        if constexpr (Format::layout == trivial_layout::packed) {
+            return is_packable<T>();
+        }
+        else {
+            return false;
+        }
+    }
+
+    // Serialized size of trivially serializable types.
+    template <class T, class Format>
+    constexpr size_t get_trivial_size() noexcept {
+        if constexpr (is_packed<T, Format>()) {
+            return get_packed_size<T>();
+        }
+        else {
+            return sizeof(T);
+        }
+    }
+
+    struct copy_block {
+        size_t offset = 0;
+        size_t size   = 0;
+    };
+
+    template <class T>
+    constexpr size_t get_max_copy_blocks() noexcept;
+
+    template <class T, size_t...Is>
+    constexpr size_t get_fields_max_copy_blocks(std::index_sequence<Is...>) noexcept {
+        using fields = field_types_t<T, sizeof...(Is)>;
+        return (get_max_copy_blocks<std::tuple_element_t<Is, fields>>() + ... + 0);
+    }
+
+    template <class T>
+    constexpr size_t get_max_copy_blocks() noexcept {
+        if constexpr (!is_packable<T>()) {
+            return 1;
+        }
+        else if constexpr (is_range_v<T>) {
+            return get_fixed_size<T>() * get_max_copy_blocks<typename range_traits<T>::value_type>();
+        }
+        else {
+            return get_fields_max_copy_blocks<T>(std::make_index_sequence<get_members_count<T>()>{});
+        }
+    }
+
+    template <class T, size_t N>
+    constexpr void add_copy_blocks(std::array<copy_block, N>& blocks, size_t& count, size_t offset) noexcept;
+
+    template <class T, size_t N, size_t...Is>
+    constexpr void add_fields_copy_blocks(std::array<copy_block, N>& blocks, size_t& count, size_t offset, std::index_sequence<Is...>) noexcept {
+        using fields = field_types_t<T, sizeof...(Is)>;
+        constexpr auto offsets = field_offsets_v<T, sizeof...(Is)>;
+        (add_copy_blocks<std::tuple_element_t<Is, fields>>(blocks, count, offset + offsets[Is]), ...);
+    }
+
+    // Adjacent fields are merged in the same block.
+    template <class T, size_t N>
+    constexpr void add_copy_blocks(std::array<copy_block, N>& blocks, size_t& count, size_t offset) noexcept {
+        if constexpr (!is_packable<T>()) {
+            if (count > 0 && blocks[count - 1].offset + blocks[count - 1].size == offset) {
+                blocks[count - 1].size += sizeof(T);
+            }
+            else {
+                blocks[count++] = { offset, sizeof(T) };
+            }
+        }
+        else if constexpr (is_range_v<T>) {
+            using value_type = typename range_traits<T>::value_type;
+            for (size_t i = 0; i < get_fixed_size<T>(); ++i) {
+                add_copy_blocks<value_type>(blocks, count, offset + i * sizeof(value_type));
+            }
+        }
+        else {
+            add_fields_copy_blocks<T>(blocks, count, offset, std::make_index_sequence<get_members_count<T>()>{});
+        }
+    }
+
+    template <class T>
+    constexpr auto get_copy_blocks() noexcept {
+        auto blocks = std::array<copy_block, get_max_copy_blocks<T>()>{};
+        size_t count = 0;
+        add_copy_blocks<T>(blocks, count, 0);
+        return std::pair{ blocks, count };
+    }
+
+    // Blocks of bytes of a packable aggregate which are copied in order to pack it.
+    template <class T>
+    constexpr auto copy_plan_v = [] {
+        constexpr auto blocks = get_copy_blocks<T>();
+        auto plan = std::array<copy_block, blocks.second>{};
+        for (size_t i = 0; i < plan.size(); ++i) plan[i] = blocks.first[i];
+        return plan;
+    }();
+
+    template <class T>
+    void pack(T const& value, std::byte* data) noexcept;
+    template <class T>
+    void unpack(T& value, std::byte const* data) noexcept;
+
+    // Packs the fields one after the other, wherever they lie in the value.
+    template <class T, size_t...Is>
+    void pack_fields(T const& value, std::byte* data, std::index_sequence<Is...>) noexcept {
+        auto const fields = as_tuple(value);
+        ([&] {
+            auto const& field = std::get<Is>(fields);
+            using field_t = remove_cvref_t<decltype(field)>;
+            if constexpr (is_packable<field_t>()) pack(field, data);
+            else memcpy(data, &field, sizeof(field));
+            data += get_packed_size<field_t>();
+        }(), ...);
+    }
+    template <class T, size_t...Is>
+    void unpack_fields(T& value, std::byte const* data, std::index_sequence<Is...>) noexcept {
+        auto const fields = as_tuple(value);
+        ([&] {
+            auto& field = std::get<Is>(fields);
+            using field_t = remove_cvref_t<decltype(field)>;
+            if constexpr (is_packable<field_t>()) unpack(field, data);
+            else memcpy(&field, data, sizeof(field));
+            data += get_packed_size<field_t>();
+        }(), ...);
+    }
+
+    template <class T>
+    void pack(T const& value, std::byte* data) noexcept {
+        if constexpr (is_range_v<T>) {
+            for (auto& element : value) {
+                pack(element, data);
+                data += get_packed_size<typename range_traits<T>::value_type>();
+            }
+        }
+        else if (has_computed_layout(value)) {
+            auto const bytes = reinterpret_cast<std::byte const*>(&value);
+            for (auto& block : copy_plan_v<T>) {
+                memcpy(data, bytes + block.offset, block.size);
+                data += block.size;
+            }
+        }
+        else {
+            pack_fields(value, data, std::make_index_sequence<get_members_count<T>()>{});
+        }
+    }
     template <class T>
-    void do_serialize(T const& container, span<std::byte>& buffer, value_tag<serialization_category::container>) noexcept {
-        size_t const count = range_traits<T>::size(container);
-        serialize(count, buffer);
-        serialize_range(container, buffer);
+    void unpack(T& value, std::byte const* data) noexcept {
+        if constexpr (is_range_v<T>) {
+            for (auto& element : value) {
+                unpack(element, data);
+                data += get_packed_size<typename range_traits<T>::value_type>();
+            }
+        }
+        else if (has_computed_layout(value)) {
+            auto const bytes = reinterpret_cast<std::byte*>(&value);
+            for (auto& block : copy_plan_v<T>) {
+                memcpy(bytes + block.offset, data, block.size);
+                data += block.size;
+            }
+        }
+        else {
+            unpack_fields(value, data, std::make_index_sequence<get_members_count<T>()>{});
+        }
     }
+
+    template <class T>
+    constexpr bool is_scalar_v = std::is_arithmetic_v<T> || std::is_enum_v<T>;
+
+    // Number of scalars of more than one byte in a trivial value, whose bytes are reversed in foreign byte orders.
     template <class T>
-    void do_serialize(T const& array, span<std::byte>& buffer, value_tag<serialization_category::fixed_array>) noexcept {
-        serialize_range(array, buffer);
+    constexpr size_t get_swaps_count() noexcept;
+
+    template <class T, size_t...Is>
+    constexpr size_t get_fields_swaps_count(std::index_sequence<Is...>) noexcept {
+        using fields = field_types_t<T, sizeof...(Is)>;
+        return (get_swaps_count<std::tuple_element_t<Is, fields>>() + ... + 0);
+    }
+
+    template <class T>
+    constexpr size_t get_swaps_count() noexcept {
+        if constexpr (is_scalar_v<T>) {
+            return sizeof(T) > 1 ? 1 : 0;
+        }
+        else if constexpr (is_range_v<T> && no_adl::has_fixed_size<T>()) {
+            return get_fixed_size<T>() * get_swaps_count<typename range_traits<T>::value_type>();
+        }
+        else if constexpr (has_computable_layout<T>()) {
+            return get_fields_swaps_count<T>(std::make_index_sequence<get_members_count<T>()>{});
+        }
+        else {
+            static_assert(always_false_v<T>, "Only scalars, and fixed size arrays and aggregates of them, can be byte swapped");
+            return 0;
+        }
+    }
+
+    template <class T, class Format>
+    constexpr bool needs_byte_swap() noexcept {
+        if constexpr (is_foreign_order_v<Format>) {
+            return get_swaps_count<T>() > 0;
+        }
+        else {
+            return false;
+        }
+    }
+
+    template <class T, bool Packed, size_t N>
+    constexpr void add_swaps(std::array<copy_block, N>& swaps, size_t& count, size_t offset) noexcept;
+
+    template <class T, bool Packed, size_t N, size_t...Is>
+    constexpr void add_fields_swaps(std::array<copy_block, N>& swaps, size_t& count, size_t offset, std::index_sequence<Is...>) noexcept {
+        using fields = field_types_t<T, sizeof...(Is)>;
+        constexpr auto offsets = field_offsets_v<T, sizeof...(Is)>;
+        ((add_swaps<std::tuple_element_t<Is, fields>, Packed>(swaps, count, offset + (Packed ? 0 : offsets[Is])),
+          offset += Packed ? get_packed_size<std::tuple_element_t<Is, fields>>() : 0), ...);
+    }
+
+    // Packed values are laid out field after field.
+    template <class T, bool Packed, size_t N>
+    constexpr void add_swaps(std::array<copy_block, N>& swaps, size_t& count, size_t offset) noexcept {
+        if constexpr (is_scalar_v<T>) {
+            if (sizeof(T) > 1) swaps[count++] = { offset, sizeof(T) };
+        }
+        else if constexpr (is_range_v<T>) {
+            using value_type = typename range_traits<T>::value_type;
+            constexpr auto size = Packed ? get_packed_size<value_type>() : sizeof(value_type);
+            for (size_t i = 0; i < get_fixed_size<T>(); ++i) {
+                add_swaps<value_type, Packed>(swaps, count, offset + i * size);
+            }
+        }
+        else {
+            add_fields_swaps<T, Packed>(swaps, count, offset, std::make_index_sequence<get_members_count<T>()>{});
+        }
+    }
+
+    // Scalars of the serialized bytes of a trivial value, reversed in foreign byte orders.
+    template <class T, bool Packed>
+    constexpr auto swap_plan_v = [] {
+        auto swaps = std::array<copy_block, get_swaps_count<T>()>{};
+        size_t count = 0;
+        add_swaps<T, Packed>(swaps, count, 0);
+        return swaps;
+    }();
+
+    // Reverses the scalars of a trivial value in place, through the addresses of its fields.
+    template <class T>
+    void swap_fields(T& value) noexcept {
+        if constexpr (is_scalar_v<T>) {
+            byte_swap::swap_bytes(reinterpret_cast<std::byte*>(&value), sizeof(T));
+        }
+        else if constexpr (is_range_v<T>) {
+            for (auto& element : value) swap_fields(element);
+        }
+        else {
+            std::apply([] (auto&...fields) { (swap_fields(fields), ...); }, as_tuple(value));
+        }
+    }
+
+    template <class Format, class T>
+    void write_swapped(T const* values, size_t count, std::byte* data) noexcept {
+        if constexpr (is_scalar_v<T>) {
+            byte_swap::copy_swapped<sizeof(T)>(data, reinterpret_cast<std::byte const*>(values), count);
+        }
+        else {
+            constexpr auto size = get_trivial_size<T, Format>();
+            for (auto it = values; it != values + count; ++it, data += size) {
+                // Packed values are laid out field after field, whatever their layout in memory.
+                if constexpr (!is_packed<T, Format>()) {
+                    if (!has_computed_layout(*it)) {
+                        auto value = *it;
+                        swap_fields(value);
+                        memcpy(data, &value, size);
+                        continue;
+                    }
+                }
+                if constexpr (is_packed<T, Format>()) pack(*it, data);
+                else memcpy(data, it, size);
+                for (auto& swap : swap_plan_v<T, is_packed<T, Format>()>) byte_swap::swap_bytes(data + swap.offset, swap.size);
+            }
+        }
+    }
+    template <class Format, class T>
+    void read_swapped(T* values, size_t count, std::byte const* data) noexcept {
+        if constexpr (is_scalar_v<T>) {
+            byte_swap::copy_swapped<sizeof(T)>(reinterpret_cast<std::byte*>(values), data, count);
+        }
+        else {
+            constexpr auto size = get_trivial_size<T, Format>();
+            std::byte bytes[size];
+            for (auto it = values; it != values + count; ++it, data += size) {
+                if constexpr (!is_packed<T, Format>()) {
+                    if (!has_computed_layout(*it)) {
+                        memcpy(it, data, size);
+                        swap_fields(*it);
+                        continue;
+                    }
+                }
+                memcpy(bytes, data, size);
+                for (auto& swap : swap_plan_v<T, is_packed<T, Format>()>) byte_swap::swap_bytes(bytes + swap.offset, swap.size);
+                if constexpr (is_packed<T, Format>()) unpack(*it, bytes);
+                else memcpy(it, bytes, size);
+            }
+        }
+    }
+
+    // Foreign byte orders go through a stack buffer, unless the buffer is a span.
+    constexpr size_t swap_chunk_size = 256;
+
+    // Trivial values are copied as is, or without their padding in packed formats, and have
+    // their scalars reversed in foreign byte orders.
+    template <class Format, bool Checked, class T, class Buffer>
+    bool write_trivials(T const* values, size_t count, Buffer& buffer) {
+        if constexpr (needs_byte_swap<T, Format>()) {
+            constexpr auto size = get_trivial_size<T, Format>();
+            if constexpr (is_span_buffer_v<Buffer>) {
+                if constexpr (Checked) {
+                    if (buffer.size() / size < count) return false;
+                }
+                write_swapped<Format>(values, count, buffer.data());
+                buffer.begin() += count * size;
+            }
+            else {
+                static_assert(!Checked, "Only span buffers can be checked");
+                constexpr auto chunk = std::max<size_t>(swap_chunk_size / size, 1);
+                std::byte bytes[chunk * size];
+                for (size_t i = 0; i < count; i += chunk) {
+                    auto const n = std::min(chunk, count - i);
+                    write_swapped<Format>(values + i, n, bytes);
+                    buffer.write(bytes, n * size);
+                }
+            }
+            return true;
+        }
+        else if constexpr (is_packed<T, Format>()) {
+            constexpr auto size = get_packed_size<T>();
+            if constexpr (is_span_buffer_v<Buffer>) {
+                if constexpr (Checked) {
+                    if (buffer.size() / size < count) return false;
+                }
+                for (auto it = values; it != values + count; ++it) {
+                    pack(*it, buffer.data());
+                    buffer.begin() += size;
+                }
+            }
+            else {
+                static_assert(!Checked, "Only span buffers can be checked");
+                std::byte bytes[size];
+                for (auto it = values; it != values + count; ++it) {
+                    pack(*it, bytes);
+                    buffer.write(bytes, size);
+                }
+            }
+            return true;
+        }
+        else {
+            return write_bytes<Checked>(values, count * sizeof(T), buffer);
+        }
+    }
+    template <class Format, bool Checked, class T, class Buffer>
+    bool read_trivials(T* values, size_t count, Buffer& buffer) {
+        if constexpr (needs_byte_swap<T, Format>()) {
+            constexpr auto size = get_trivial_size<T, Format>();
+            if constexpr (Checked) {
+                if (buffer.size() / size < count) return false;
+            }
+            if constexpr (is_span_source_v<Buffer>) {
+                read_swapped<Format>(values, count, buffer.data());
+                buffer.begin() += count * size;
+            }
+            else {
+                constexpr auto chunk = std::max<size_t>(swap_chunk_size / size, 1);
+                std::byte bytes[chunk * size];
+                for (size_t i = 0; i < count; i += chunk) {
+                    auto const n = std::min(chunk, count - i);
+                    if (!read_source(bytes, n * size, buffer)) return false;
+                    read_swapped<Format>(values + i, n, bytes);
+                }
+            }
+            return true;
+        }
+        else if constexpr (is_packed<T, Format>()) {
+            constexpr auto size = get_packed_size<T>();
+            if constexpr (Checked) {
+                if (buffer.size() / size < count) return false;
+            }
+            for (auto it = values; it != values + count; ++it) {
+                if constexpr (is_span_source_v<Buffer>) {
+                    unpack(*it, buffer.data());
+                    buffer.begin() += size;
+                }
+                else {
+                    std::byte bytes[size];
+                    if (!read_source(bytes, size, buffer)) return false;
+                    unpack(*it, bytes);
+                }
+            }
+            return true;
+        }
+        else {
+            return read_bytes<Checked>(values, count * sizeof(T), buffer);
+        }
+    }
+}
+
+// bit runs
+
+namespace detail {
+    // Place of a bit packed element in the words of its run, the adjacent bit packed elements
+    // of a tuple. Each word holds up to 64 bits and is written on the bytes holding its bits,
+    // lowest first, after the last element of the run.
+    struct bit_slot {
+        size_t word       = 0;
+        unsigned shift    = 0;
+        size_t first_word = 0;
+        size_t end_word   = 0;
+        size_t run_size   = 0;
+        bool is_first = false;
+        bool is_last  = false;
+    };
+
+    template <size_t N>
+    struct bit_plan {
+        std::array<bit_slot, N> slots{};
+        std::array<unsigned, N> word_bits{};
+        size_t words_count = 0;
+    };
+
+    template <class T>
+    constexpr unsigned get_bit_width() noexcept {
+        if constexpr (is_bit_packed_v<T>) return bits::width_v<T>;
+        else return 0;
+    }
+
+    template <class Fields, size_t...Is>
+    constexpr auto get_bit_plan(std::index_sequence<Is...>) noexcept {
+        constexpr size_t count = sizeof...(Is);
+        constexpr bool is_packed[]  = { is_bit_packed_v<remove_cvref_t<std::tuple_element_t<Is, Fields>>>..., false };
+        constexpr unsigned widths[] = { get_bit_width<remove_cvref_t<std::tuple_element_t<Is, Fields>>>()..., 0 };
+
+        auto plan = bit_plan<count>{};
+        auto& words = plan.words_count;
+        size_t first = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (!is_packed[i]) continue;
+            auto& slot = plan.slots[i];
+            slot.is_first = i == 0 || !is_packed[i - 1];
+            slot.is_last  = !is_packed[i + 1];
+            if (slot.is_first) first = i;
+            if (slot.is_first || plan.word_bits[words - 1] + widths[i] > 64 || plan.word_bits[words - 1] == 64) ++words;
+            slot.word  = words - 1;
+            slot.shift = plan.word_bits[words - 1];
+            plan.word_bits[words - 1] += widths[i];
+            if (!slot.is_last) continue;
+
+            auto const first_word = plan.slots[first].word;
+            size_t run_size = 0;
+            for (auto w = first_word; w < words; ++w) run_size += (plan.word_bits[w] + 7) / 8;
+            for (auto j = first; j <= i; ++j) {
+                plan.slots[j].first_word = first_word;
+                plan.slots[j].end_word   = words;
+                plan.slots[j].run_size   = run_size;
+            }
+        }
+        return plan;
+    }
+
+    template <class Fields>
+    constexpr auto bit_plan_v = get_bit_plan<Fields>(std::make_index_sequence<std::tuple_size_v<Fields>>{});
+
+    // Bits of the runs of a tuple, while it is processed element by element.
+    template <class Fields>
+    using bit_words_t = std::array<uint64_t, bit_plan_v<Fields>.words_count>;
+
+    template <class Fields>
+    constexpr bool has_bit_runs() noexcept {
+        return bit_plan_v<Fields>.words_count > 0;
+    }
+
+    template <bool Checked, class Fields, size_t I, class Buffer>
+    bool write_bit_run(bit_words_t<Fields> const& words, Buffer& buffer) {
+        constexpr auto& plan = bit_plan_v<Fields>;
+        constexpr auto slot  = plan.slots[I];
+        if constexpr (slot.run_size == 0) {
+            return true;
+        }
+        else {
+            std::byte bytes[slot.run_size];
+            size_t size = 0;
+            for (auto w = slot.first_word; w < slot.end_word; ++w) {
+                for (unsigned b = 0; b < plan.word_bits[w]; b += 8) bytes[size++] = static_cast<std::byte>(words[w] >> b);
+            }
+            return write_bytes<Checked>(bytes, slot.run_size, buffer);
+        }
+    }
+    template <bool Checked, class Fields, size_t I, class Buffer>
+    bool read_bit_run(bit_words_t<Fields>& words, Buffer& buffer) {
+        constexpr auto& plan = bit_plan_v<Fields>;
+        constexpr auto slot  = plan.slots[I];
+        if constexpr (slot.run_size == 0) {
+            return true;
+        }
+        else {
+            std::byte bytes[slot.run_size];
+            if (!read_bytes<Checked>(bytes, slot.run_size, buffer)) return false;
+            size_t size = 0;
+            for (auto w = slot.first_word; w < slot.end_word; ++w) {
+                words[w] = 0;
+                for (unsigned b = 0; b < plan.word_bits[w]; b += 8) words[w] |= static_cast<uint64_t>(bytes[size++]) << b;
+            }
+            return true;
+        }
+    }
+
+    // Element I of a tuple whose elements are of types Fields. Bit packed elements are
+    // gathered in the words, and their run is written with its last element.
+    template <class Format, bool Checked, class Fields, size_t I, class T, class Buffer>
+    bool serialize_field(T const& value, bit_words_t<Fields>& words, Buffer& buffer) {
+        using value_type = std::remove_const_t<T>;
+        if constexpr (is_bit_packed_v<value_type>) {
+            constexpr auto slot = bit_plan_v<Fields>.slots[I];
+            words[slot.word] |= (bits::to_bits<value_type>(value) & bits::mask_v<value_type>) << slot.shift;
+            if constexpr (slot.is_last) {
+                return write_bit_run<Checked, Fields, I>(words, buffer);
+            }
+            else {
+                return true;
+            }
+        }
+        else {
+            return serialize_value<Format, Checked>(value, buffer);
+        }
+    }
+    // Bit runs are read with their first element, then each element is shifted out of the words.
+    template <class Format, bool Checked, class Fields, size_t I, class T, class Buffer>
+    bool deserialize_field(T& value, bit_words_t<Fields>& words, Buffer& buffer) {
+        if constexpr (is_bit_packed_v<T>) {
+            constexpr auto slot = bit_plan_v<Fields>.slots[I];
+            if constexpr (slot.is_first) {
+                if (!read_bit_run<Checked, Fields, I>(words, buffer)) return false;
+            }
+            return bits::from_bits<Checked>(value, (words[slot.word] >> slot.shift) & bits::mask_v<T>);
+        }
+        else {
+            return deserialize_value<Format, Checked>(value, buffer);
+        }
+    }
+    template <class Format, class Fields, size_t I, class T>
+    constexpr size_t get_field_size(T const& value) noexcept {
+        if constexpr (is_bit_packed_v<std::remove_const_t<T>>) {
+            constexpr auto slot = bit_plan_v<Fields>.slots[I];
+            return slot.is_first ? slot.run_size : 0;
+        }
+        else {
+            return get_serialized_size<Format>(value);
+        }
+    }
+    template <class Format, class Fields, size_t I>
+    bool try_get_field_size(span<std::byte const>& buffer, bit_words_t<Fields>& words) noexcept {
+        using value_type = remove_deep_constness_t<remove_cvref_t<std::tuple_element_t<I, Fields>>>;
+        if constexpr (is_bit_packed_v<value_type>) {
+            auto value = value_type{};
+            return deserialize_field<Format, true, Fields, I>(value, words, buffer);
+        }
+        else {
+            auto const [size, success] = try_get_deserialized_size<value_type, Format>(buffer);
+            if (!success) return false;
+            buffer.begin() += size;
+            return true;
+        }
+    }
+
+    // Processes the elements Is of a tuple, which can be a subset of its elements made of whole bit runs.
+    template <class Format, bool Checked, class Fields, class Tuple, class Buffer, size_t...Is>
+    bool serialize_fields(Tuple const& tuple, Buffer& buffer, std::index_sequence<Is...>) {
+        auto words = bit_words_t<Fields>{};
+        return (serialize_field<Format, Checked, Fields, Is>(std::get<Is>(tuple), words, buffer) && ...);
+    }
+    template <class Format, bool Checked, class Fields, class Tuple, class Buffer, size_t...Is>
+    bool deserialize_fields(Tuple& tuple, Buffer& buffer, std::index_sequence<Is...>) {
+        auto words = bit_words_t<Fields>{};
+        return (deserialize_field<Format, Checked, Fields, Is>(std::get<Is>(tuple), words, buffer) && ...);
+    }
+    template <class Format, class Fields, class Tuple, size_t...Is>
+    constexpr size_t get_fields_size(Tuple const& tuple, std::index_sequence<Is...>) noexcept {
+        return (get_field_size<Format, Fields, Is>(std::get<Is>(tuple)) + ... + 0);
+    }
+    template <class Format, class Fields, size_t...Is>
+    bool try_get_fields_size(span<std::byte const>& buffer, std::index_sequence<Is...>) noexcept {
+        auto words = bit_words_t<Fields>{};
+        return (try_get_field_size<Format, Fields, Is>(buffer, words) && ...);
+    }
+
+    template <size_t First, size_t...Is>
+    constexpr auto offset_sequence(std::index_sequence<Is...>) noexcept {
+        return std::index_sequence<First + Is...>{};
+    }
+}
+
+// field runs
+
+namespace detail {
+    // Fields copied as is, whose bytes can be merged with the adjacent ones.
+    template <class T, class Format>
+    constexpr bool is_block_copyable() noexcept {
+        if constexpr (serialization_category_v<T> == serialization_category::trivial) {
+            return !is_packed<T, Format>() && !needs_byte_swap<T, Format>();
+        }
+        else {
+            return false;
+        }
+    }
+
+    // Either a run of adjacent block copyable fields, a bit run, or a single field processed by its category.
+    struct field_step {
+        size_t field  = 0;
+        size_t offset = 0;
+        size_t size   = 0;
+        bool is_block = false;
+        bool is_bits  = false;
+        size_t fields_count = 1;
+    };
+
+    template <class T, class Format, size_t...Is>
+    constexpr auto get_field_steps(std::index_sequence<Is...>) noexcept {
+        using fields = field_types_t<T, sizeof...(Is)>;
+        constexpr auto offsets = field_offsets_v<T, sizeof...(Is)>;
+        constexpr size_t sizes[]   = { sizeof(std::tuple_element_t<Is, fields>)... };
+        constexpr bool is_block[]  = { is_block_copyable<std::tuple_element_t<Is, fields>, Format>()... };
+        constexpr bool is_bits[]   = { is_bit_packed_v<std::tuple_element_t<Is, fields>>... };
+
+        auto steps = std::array<field_step, sizeof...(Is)>{};
+        size_t count = 0;
+        for (size_t i = 0; i < sizeof...(Is); ++i) {
+            if (count > 0 && is_block[i] && steps[count - 1].is_block
+                && steps[count - 1].offset + steps[count - 1].size == offsets[i]) {
+                steps[count - 1].size += sizes[i];
+            }
+            else if (count > 0 && is_bits[i] && steps[count - 1].is_bits) {
+                ++steps[count - 1].fields_count;
+            }
+            else {
+                steps[count++] = { i, offsets[i], sizes[i], is_block[i], is_bits[i] };
+            }
+        }
+        return std::pair{ steps, count };
+    }
+
+    template <class T, class Format>
+    constexpr auto field_steps_v = [] {
+        constexpr auto steps = get_field_steps<T, Format>(std::make_index_sequence<airity_v<T>>{});
+        auto result = std::array<field_step, steps.second>{};
+        for (size_t i = 0; i < result.size(); ++i) result[i] = steps.first[i];
+        return result;
+    }();
+
+    // Aggregates with runs of several trivial fields, copied with one memcpy per run, or with bit runs.
+    // Values whose fields don't lie at their computed offsets are processed field by field, with
+    // the same bytes.
+    template <class T, class Format>
+    constexpr bool has_field_runs() noexcept {
+        if constexpr (std::is_standard_layout_v<T> && matches_layout<T, airity_v<T>>()) {
+            return field_steps_v<T, Format>.size() < airity_v<T>;
+        }
+        else {
+            return false;
+        }
+    }
+
+    template <class Format, bool Checked, class T, class Buffer, size_t...Ss>
+    bool serialize_field_steps(T const& value, Buffer& buffer, std::index_sequence<Ss...>) {
+        auto const fields = as_tuple(value);
+        auto const bytes  = reinterpret_cast<std::byte const*>(&value);
+        return ([&] {
+            constexpr auto step = field_steps_v<T, Format>[Ss];
+            if constexpr (step.is_block) {
+                return write_bytes<Checked>(bytes + step.offset, step.size, buffer);
+            }
+            else if constexpr (step.is_bits) {
+                constexpr auto indices = offset_sequence<step.field>(std::make_index_sequence<step.fields_count>{});
+                return serialize_fields<Format, Checked, field_types_t<T>>(fields, buffer, indices);
+            }
+            else {
+                return serialize_value<Format, Checked>(std::get<step.field>(fields), buffer);
+            }
+        }() && ...);
+    }
+    template <class Format, bool Checked, class T, class Buffer, size_t...Ss>
+    bool deserialize_field_steps(T& value, Buffer& buffer, std::index_sequence<Ss...>) {
+        auto const fields = as_tuple(value);
+        auto const bytes  = reinterpret_cast<std::byte*>(&value);
+        return ([&] {
+            constexpr auto step = field_steps_v<T, Format>[Ss];
+            if constexpr (step.is_block) {
+                return read_bytes<Checked>(bytes + step.offset, step.size, buffer);
+            }
+            else if constexpr (step.is_bits) {
+                constexpr auto indices = offset_sequence<step.field>(std::make_index_sequence<step.fields_count>{});
+                return deserialize_fields<Format, Checked, field_types_t<T>>(fields, buffer, indices);
+            }
+            else {
+                return deserialize_value<Format, Checked>(std::get<step.field>(fields), buffer);
+            }
+        }() && ...);
+    }
+    template <class Format, class T, size_t...Ss>
+    constexpr size_t get_field_steps_size(T const& value, std::index_sequence<Ss...>) noexcept {
+        auto const fields = as_tuple(value);
+        return ([&] {
+            constexpr auto step = field_steps_v<T, Format>[Ss];
+            if constexpr (step.is_block) {
+                return step.size;
+            }
+            else if constexpr (step.is_bits) {
+                return bit_plan_v<field_types_t<T>>.slots[step.field].run_size;
+            }
+            else {
+                return get_serialized_size<Format>(std::get<step.field>(fields));
+            }
+        }() + ... + 0);
+    }
+    template <class T, class Format, size_t...Ss>
+    std::pair<size_t, bool> try_get_field_steps_size(span<std::byte const> buffer, std::index_sequence<Ss...>) noexcept {
+        using fields = field_types_t<T>;
+        auto const data_begin = buffer.begin();
+        auto const success = ([&] {
+            constexpr auto step = field_steps_v<T, Format>[Ss];
+            if constexpr (step.is_block) {
+                if (buffer.size() < step.size) return false;
+                buffer.begin() += step.size;
+                return true;
+            }
+            else if constexpr (step.is_bits) {
+                constexpr auto indices = offset_sequence<step.field>(std::make_index_sequence<step.fields_count>{});
+                return try_get_fields_size<Format, fields>(buffer, indices);
+            }
+            else {
+                using field = std::tuple_element_t<step.field, fields>;
+                auto const [size, success] = try_get_deserialized_size<field, Format>(buffer);
+                if (!success) return false;
+                buffer.begin() += size;
+                return true;
+            }
+        }() && ...);
+        return { buffer.begin() - data_begin, success };
+    }
+}
+
+// static sizes
+
+constexpr size_t unbounded_serialized_size = SIZE_MAX;
+
+namespace detail {
+    constexpr size_t add_max_sizes(size_t lhs, size_t rhs) noexcept {
+        return (lhs == unbounded_serialized_size || rhs == unbounded_serialized_size)
+            ? unbounded_serialized_size : lhs + rhs;
+    }
+
+    template <class T, class Format>
+    constexpr size_t get_min_serialized_size() noexcept;
+    template <class T, class Format>
+    constexpr size_t get_max_serialized_size() noexcept;
+
+    // Bit packed elements account for their run once.
+    template <class T, class Format, bool Max, size_t...Is>
+    constexpr size_t get_elements_static_size(std::index_sequence<Is...>) noexcept {
+        constexpr auto& plan = bit_plan_v<T>;
+        size_t size = 0;
+        ([&] {
+            using element = remove_cvref_t<std::tuple_element_t<Is, T>>;
+            if constexpr (is_bit_packed_v<element>) {
+                if (plan.slots[Is].is_first) size += plan.slots[Is].run_size;
+            }
+            else if constexpr (Max) {
+                size = add_max_sizes(size, get_max_serialized_size<element, Format>());
+            }
+            else {
+                size += get_min_serialized_size<element, Format>();
+            }
+        }(), ...);
+        return size;
+    }
+
+    template <class T, class Format, bool Max, size_t...Is>
+    constexpr size_t get_alternatives_static_size(std::index_sequence<Is...>) noexcept {
+        if constexpr (Max) {
+            return std::max({ get_max_serialized_size<remove_cvref_t<std::variant_alternative_t<Is, T>>, Format>()... });
+        }
+        else {
+            return std::min({ get_min_serialized_size<remove_cvref_t<std::variant_alternative_t<Is, T>>, Format>()... });
+        }
+    }
+
+    // Lower bound of the serialized size of any T, used to reject impossible element counts.
+    template <class T, class Format>
+    constexpr size_t get_min_serialized_size() noexcept {
+        constexpr auto category = serialization_category_v<T>;
+        if constexpr (category == serialization_category::trivial) {
+            return get_trivial_size<T, Format>();
+        }
+        else if constexpr (category == serialization_category::bit_packed) {
+            return bit_plan_v<std::tuple<T>>.slots[0].run_size;
+        }
+        else if constexpr (category == serialization_category::fixed_array) {
+            return get_fixed_size<T>() * get_min_serialized_size<typename range_traits<T>::value_type, Format>();
+        }
+        else if constexpr (category == serialization_category::tuple) {
+            return get_elements_static_size<T, Format, false>(std::make_index_sequence<get_fixed_size<T>()>{});
+        }
+        else if constexpr (category == serialization_category::optional) {
+            return sizeof(uint8_t);
+        }
+        else if constexpr (category == serialization_category::variant) {
+            return sizeof(variant_index_t<T>)
+                + get_alternatives_static_size<T, Format, false>(std::make_index_sequence<std::variant_size_v<T>>{});
+        }
+        else if constexpr (category == serialization_category::aggregate) {
+            return get_min_serialized_size<to_tuple_t<T>, Format>();
+        }
+        else if constexpr (category == serialization_category::encoded_array) {
+            return 2 * get_serialized_size_size<Format>(0);
+        }
+        else {
+            return get_serialized_size_size<Format>(0);
+        }
+    }
+
+    // Upper bound of the serialized size of any T, or unbounded_serialized_size.
+    template <class T, class Format>
+    constexpr size_t get_max_serialized_size() noexcept {
+        constexpr auto category = serialization_category_v<T>;
+        if constexpr (category == serialization_category::trivial) {
+            return get_trivial_size<T, Format>();
+        }
+        else if constexpr (category == serialization_category::bit_packed) {
+            return bit_plan_v<std::tuple<T>>.slots[0].run_size;
+        }
+        else if constexpr (category == serialization_category::fixed_array) {
+            constexpr auto size = get_max_serialized_size<typename range_traits<T>::value_type, Format>();
+            return size == unbounded_serialized_size ? size : get_fixed_size<T>() * size;
+        }
+        else if constexpr (category == serialization_category::tuple) {
+            return get_elements_static_size<T, Format, true>(std::make_index_sequence<get_fixed_size<T>()>{});
+        }
+        else if constexpr (category == serialization_category::optional) {
+            return add_max_sizes(sizeof(uint8_t), get_max_serialized_size<typename T::value_type, Format>());
+        }
+        else if constexpr (category == serialization_category::variant) {
+            return add_max_sizes(sizeof(variant_index_t<T>),
+                get_alternatives_static_size<T, Format, true>(std::make_index_sequence<std::variant_size_v<T>>{}));
+        }
+        else if constexpr (category == serialization_category::aggregate) {
+            return get_max_serialized_size<to_tuple_t<T>, Format>();
+        }
+        else {
+            return unbounded_serialized_size;
+        }
+    }
+}
+
+template <class T, class Format = native_format>
+constexpr size_t max_serialized_size_v = detail::get_max_serialized_size<remove_cvref_t<T>, Format>();
+
+template <class T, class Format = native_format>
+constexpr bool has_max_serialized_size_v = max_serialized_size_v<T, Format> != unbounded_serialized_size;
+
+// True when all the values of T have the same serialized size.
+template <class T, class Format = native_format>
+constexpr bool has_static_serialized_size_v = has_max_serialized_size_v<T, Format>
+    && max_serialized_size_v<T, Format> == detail::get_min_serialized_size<remove_cvref_t<T>, Format>();
+
+template <class T, class Format = native_format>
+constexpr size_t serialized_size_v = [] {
+    static_assert(has_static_serialized_size_v<T, Format>, "The serialized size of T depends on its value");
+    return max_serialized_size_v<T, Format>;
+}();
+
+namespace detail {
+    // Values of static size are only checked for their size, unless their bytes can hold
+    // invalid values : bit patterns out of the range of a bit packed element, or discriminants.
+    template <class T>
+    constexpr bool has_invalid_patterns() noexcept {
+        constexpr auto category = serialization_category_v<T>;
+        if constexpr (category == serialization_category::bit_packed) {
+            return !bits::is_exhaustive_v<T>;
+        }
+        else if constexpr (category == serialization_category::optional || category == serialization_category::variant) {
+            return true;
+        }
+        else if constexpr (category == serialization_category::fixed_array) {
+            return has_invalid_patterns<typename range_traits<T>::value_type>();
+        }
+        else if constexpr (category == serialization_category::tuple) {
+            return std::apply([] (auto...tags) {
+                return (has_invalid_patterns<remove_cvref_t<typename decltype(tags)::type>>() || ...);
+            }, map_tuple_types_t<T, tag_type>{});
+        }
+        else if constexpr (category == serialization_category::aggregate) {
+            return has_invalid_patterns<to_tuple_t<T>>();
+        }
+        else {
+            return false;
+        }
+    }
+
+    template <class T, class Format>
+    constexpr bool is_checked_by_size_v = has_static_serialized_size_v<T, Format> && !has_invalid_patterns<remove_cvref_t<T>>();
+}
+
+namespace detail {
+    // Caps a decoded element count to what the remaining buffer can hold, before reserving storage.
+    template <class T, class Format, class Buffer>
+    size_t get_reservable_count(size_t count, Buffer const& buffer) noexcept {
+        constexpr auto min_size = std::max<size_t>(get_min_serialized_size<T, Format>(), 1);
+        return std::min(count, buffer.size() / min_size);
+    }
+
+    // Rejects element counts which can't fit in the remaining buffer, before any allocation.
+    template <class T, class Format, bool Checked, class Buffer>
+    bool is_possible_count(size_t count, Buffer const& buffer) noexcept {
+        if constexpr (Checked) {
+            constexpr auto min_size = get_min_serialized_size<T, Format>();
+            if constexpr (min_size > 0) {
+                return count <= buffer.size() / min_size;
+            }
+        }
+        return true;
+    }
+}
+
+// serialize
+
+namespace detail {
+    template <class Format, bool Checked, class T, class Buffer, serialization_category Category>
+    bool do_serialize(T const&, Buffer&, value_tag<Category>) {
+        static_assert(serialization_category_v<T> != serialization_category::forbidden);
+        static_assert(serialization_category_v<T> != serialization_category::unknown);
+        return false;
+    }
+    template <class Format, bool Checked, class T, class Buffer>
+    bool do_serialize(T const& value, Buffer& buffer, value_tag<serialization_category::trivial>) {
+        return write_trivials<Format, Checked>(&value, 1, buffer);
+    }
+    template <class Format, bool Checked, class T, class Buffer>
+    bool do_serialize(T const& array, Buffer& buffer, value_tag<serialization_category::trivial_array>) {
+        if constexpr (is_interned<T, Format>()) {
+            return serialize_interned<Format, Checked>(array, buffer);
+        }
+        else {
+            using traits = array_traits<T>;
+            if (!serialize_size<Format, Checked>(traits::size(array), buffer)) return false;
+
+            return write_trivials<Format, Checked>(traits::data(array), traits::size(array), buffer);
+        }
+    }
+
+    template <class Format, bool Checked, class T, class Buffer>
+    bool do_serialize(T const& view, Buffer& buffer, value_tag<serialization_category::view>) {
+        return do_serialize<Format, Checked>(view, buffer, value_tag<serialization_category::trivial_array>{});
+    }
+
+    template <class Format, bool Checked, class T, class Buffer>
+    bool serialize_range(T const& range, Buffer& buffer) {
+        using traits = range_traits<T>;
+        using value_type = typename traits::value_type;
+
+        // Trivial elements are checked once for the whole range.
+        if constexpr (Checked && serialization_category_v<value_type> == serialization_category::trivial) {
+            if (buffer.size() / get_trivial_size<value_type, Format>() < static_cast<size_t>(traits::size(range))) return false;
+            return serialize_range<Format, false>(range, buffer);
+        }
+        else {
+            auto it = traits::begin(range);
+            auto const end = traits::end(range);
+            for (; it != end; ++it) {
+                if (!serialize_value<Format, Checked>(*it, buffer)) return false;
+            }
+            return true;
+        }
+    }
+
+    // Ranges with a count are indexed when they are large enough. The sizes of their blocks are
+    // computed again once the elements are written rather than kept, so that serializing doesn't
+    // allocate.
+    template <class Format, bool Checked, class T, class Buffer>
+    bool serialize_counted_range(T const& range, Buffer& buffer) {
+        using traits = range_traits<T>;
+        size_t const count = traits::size(range);
+        if (!serialize_size<Format, Checked>(count, buffer)) return false;
+        if (!has_range_index<T, Format>(count)) return serialize_range<Format, Checked>(range, buffer);
+
+        auto const elements_size = get_range_size<Format>(range);
+        if (!serialize_size<Format, Checked>(elements_size, buffer) || !serialize_range<Format, Checked>(range, buffer)) return false;
+        auto it = traits::begin(range);
+        for (size_t block = 0; block + 1 < get_blocks_count(count); ++block) {
+            size_t block_size = 0;
+            for (size_t i = 0; i < range_index_stride; ++i, ++it) block_size += get_serialized_size<Format>(*it);
+            if (!serialize_size<Format, Checked>(block_size, buffer)) return false;
+        }
+        return true;
+    }
+
+    template <class Format, bool Checked, class T, class Buffer>
+    bool do_serialize(T const& container, Buffer& buffer, value_tag<serialization_category::container>) {
+        return serialize_counted_range<Format, Checked>(container, buffer);
+    }
+    template <class Format, bool Checked, class T, class Buffer>
+    bool do_serialize(T const& array, Buffer& buffer, value_tag<serialization_category::fixed_array>) {
+        return serialize_range<Format, Checked>(array, buffer);
+    }
+    template <class Format, bool Checked, class T, class Buffer>
+    bool do_serialize(T const& array, Buffer& buffer, value_tag<serialization_category::dynamic_array>) {
+        return serialize_counted_range<Format, Checked>(array, buffer);
+    }
+
+    template <class Format, bool Checked, size_t I, class T, class Buffer>
+    bool serialize_column(T const& array, Buffer& buffer) {
+        using traits = array_traits<T>;
+        using field  = std::tuple_element_t<I, field_types_t<typename traits::value_type>>;
+        auto const data  = traits::data(array);
+        auto const count = static_cast<size_t>(traits::size(array));
+
+        // Trivial columns are checked once.
+        if constexpr (Checked && serialization_category_v<field> == serialization_category::trivial) {
+            if (buffer.size() / get_trivial_size<field, Format>() < count) return false;
+            return serialize_column<Format, false, I>(array, buffer);
+        }
+        else {
+            for (auto row = data; row != data + count; ++row) {
+                if (!serialize_value<Format, Checked>(std::get<I>(as_tuple(*row)), buffer)) return false;
+            }
+            return true;
+        }
+    }
+    template <class Format, bool Checked, class T, class Buffer, size_t...Is>
+    bool serialize_columns(T const& array, Buffer& buffer, std::index_sequence<Is...>) {
+        return (serialize_column<Format, Checked, Is>(array, buffer) && ...);
+    }
+    template <class Format, bool Checked, class T, class Buffer>
+    bool do_serialize(T const& array, Buffer& buffer, value_tag<serialization_category::columnar_array>) {
+        using value_type = typename range_traits<T>::value_type;
+        return serialize_size<Format, Checked>(range_traits<T>::size(array), buffer)
+            && serialize_columns<Format, Checked>(array, buffer, std::make_index_sequence<airity_v<value_type>>{});
+    }
+    template <class Format, bool Checked, class T, class Buffer>
+    bool do_serialize(T const& array, Buffer& buffer, value_tag<serialization_category::encoded_array>) {
+        using traits = array_traits<T>;
+        using codec  = array_codec_t<T>;
+        auto const data  = traits::data(array);
+        auto const count = static_cast<size_t>(traits::size(array));
+        auto const size  = codec::get_encoded_size(data, count);
+
+        if (!serialize_size<Format, Checked>(count, buffer) || !serialize_size<Format, Checked>(size, buffer)) return false;
+        if constexpr (is_span_buffer_v<Buffer>) {
+            if constexpr (Checked) {
+                if (buffer.size() < size) return false;
+            }
+            codec::encode(data, count, buffer.data());
+            buffer.begin() += size;
+            return true;
+        }
+        else {
+            auto bytes = std::vector<std::byte>(size);
+            codec::encode(data, count, bytes.data());
+            return write_bytes<Checked>(bytes.data(), size, buffer);
+        }
+    }
+    template <class Format, bool Checked, class T, class Buffer>
+    bool do_serialize(T const& value, Buffer& buffer, value_tag<serialization_category::bit_packed>) {
+        return serialize_fields<Format, Checked, std::tuple<T>>(std::tie(value), buffer, std::index_sequence<0>{});
+    }
+    template <class Format, bool Checked, class T, class Buffer>
+    bool do_serialize(T const& value, Buffer& buffer, value_tag<serialization_category::tuple>) {
+        if constexpr (has_bit_runs<T>()) {
+            return serialize_fields<Format, Checked, T>(value, buffer, std::make_index_sequence<get_fixed_size<T>()>{});
+        }
+        else {
+            return std::apply([&] (auto&...vals) {
+                return (serialize_value<Format, Checked>(vals, buffer) && ...);
+            }, value);
+        }
     }
-    template <class T>
-    void do_serialize(T const& array, span<std::byte>& buffer, value_tag<serialization_category::dynamic_array>) noexcept {
-        size_t const count = range_traits<T>::size(array);
-        serialize(count, buffer);
-        serialize_range(array, buffer);
+    template <class Format, bool Checked, class T, class Buffer>
+    bool do_serialize(T const& value, Buffer& buffer, value_tag<serialization_category::optional>) {
+        auto const flag = static_cast<uint8_t>(value.has_value());
+        if (!write_bytes<Checked>(&flag, sizeof(flag), buffer)) return false;
+        return !value || serialize_value<Format, Checked>(*value, buffer);
     }
-    template <class T>
-    void do_serialize(T const& value, span<std::byte>& buffer, value_tag<serialization_category::tuple>) noexcept {
-        std::apply([&] (auto&...vals) {
-            (serialize(vals, buffer), ...);
+    template <class Format, bool Checked, class T, class Buffer>
+    bool do_serialize(T const& value, Buffer& buffer, value_tag<serialization_category::variant>) {
+        assert(!value.valueless_by_exception());
+        auto const index = static_cast<variant_index_t<T>>(value.index());
+        if (!write_trivials<Format, Checked>(&index, 1, buffer)) return false;
+        return std::visit([&] (auto const& alternative) {
+            return serialize_value<Format, Checked>(alternative, buffer);
         }, value);
     }
-    template <class T>
-    void do_serialize(T const& value, span<std::byte>& buffer, value_tag<serialization_category::aggregate>) noexcept {
-        serialize(as_tuple(value), buffer);
+    template <class Format, bool Checked, class T, class Buffer>
+    bool do_serialize(T const& value, Buffer& buffer, value_tag<serialization_category::aggregate>) {
+        if constexpr (has_field_runs<T, Format>()) {
+            if (has_computed_offsets<T, airity_v<T>>(value)) {
+                return serialize_field_steps<Format, Checked>(value, buffer, std::make_index_sequence<field_steps_v<T, Format>.size()>{});
+            }
+        }
+        return serialize_value<Format, Checked>(as_tuple(value), buffer);
+    }
+
+    template <class Format, bool Checked, class T, class Buffer>
+    bool serialize_value(T const& value, Buffer& buffer) {
+        // Values of static size are checked once, then written without branches.
+        if constexpr (Checked && has_static_serialized_size_v<T, Format>) {
+            if (buffer.size() < serialized_size_v<T, Format>) return false;
+            return do_serialize<Format, false>(value, buffer, serialization_category_tag_t<T>{});
+        }
+        else {
+            return do_serialize<Format, Checked>(value, buffer, serialization_category_tag_t<T>{});
+        }
     }
 }
 
-template <class T>
-void serialize(T const& value, span<std::byte>& buffer) noexcept {
-    detail::do_serialize(value, buffer, serialization_category_tag_t<T>{});
+template <class Format, class T, class Buffer>
+void serialize(T const& value, Buffer& buffer) noexcept(is_span_buffer_v<Buffer>) {
+    detail::serialize_value<Format, false>(value, buffer);
+}
+
+template <class Format, class T, class Buffer>
+bool try_serialize(T const& value, Buffer& buffer) noexcept {
+    static_assert(is_span_buffer_v<Buffer>, "Only span buffers can be checked");
+    auto const begin = buffer.begin();
+    auto const strings = detail::get_strings_count(buffer);
+    if (!detail::serialize_value<Format, true>(value, buffer)) {
+        buffer.begin() = begin;
+        detail::forget_strings(buffer, strings);
+        return false;
+    }
+    return true;
+}
+
+template <class Format, class T>
+auto serialize_to_array(T const& value) noexcept {
+    auto array = std::array<std::byte, serialized_size_v<T, Format>>{};
+    auto buffer = span<std::byte>{ array };
+    detail::serialize_value<Format, false>(value, buffer);
+    return array;
 }
 
 // get_serialized_size
 
 namespace detail {
-    template <class T, serialization_category Category>
+    template <class Format, class T, serialization_category Category>
     constexpr void do_get_serialized_size(T const&, value_tag<Category>) noexcept {
         static_assert(serialization_category_v<T> != serialization_category::forbidden);
         static_assert(serialization_category_v<T> != serialization_category::unknown);
     }
-    template <class T>
+    template <class Format, class T>
     constexpr size_t do_get_serialized_size(T const&, value_tag<serialization_category::trivial>) noexcept {
-        return sizeof(T);
+        return get_trivial_size<T, Format>();
     }
-    template <class T>
+    template <class Format, class T>
     constexpr size_t do_get_serialized_size(T const& array, value_tag<serialization_category::trivial_array>) noexcept {
-        return sizeof(size_t) + array_traits<T>::size(array) * sizeof(typename array_traits<T>::value_type);
+        auto const count = array_traits<T>::size(array);
+        if constexpr (is_interned<T, Format>()) {
+            return get_serialized_size_size<Format>(2 * count) + count;
+        }
+        else {
+            return get_serialized_size_size<Format>(count) + count * get_trivial_size<typename array_traits<T>::value_type, Format>();
+        }
     }
 
-    template <class T>
+    template <class Format, class T>
+    constexpr size_t do_get_serialized_size(T const& view, value_tag<serialization_category::view>) noexcept {
+        return do_get_serialized_size<Format>(view, value_tag<serialization_category::trivial_array>{});
+    }
+
+    template <class Format, class T>
     constexpr size_t get_range_size(T const& range) noexcept {
         using traits = range_traits<T>;
         using value_type = typename traits::value_type;
 
         if constexpr (serialization_category_v<value_type> == serialization_category::trivial) {
-            return traits::size(range) * sizeof(value_type);
+            return traits::size(range) * get_trivial_size<value_type, Format>();
         }
         else {
             size_t size = 0;
             std::for_each(traits::begin(range), traits::end(range), [&](auto& val) {
-                size += get_serialized_size(val);
+                size += get_serialized_size<Format>(val);
             });
             return size;
         }
     }
 
-    template <class T>
+    // Indexed ranges also have the size of their elements, and of their blocks but the last.
+    template <class Format, class T>
+    constexpr size_t get_counted_range_size(T const& range) noexcept {
+        using traits = range_traits<T>;
+        auto const count = static_cast<size_t>(traits::size(range));
+        auto size = get_serialized_size_size<Format>(count);
+        if (!has_range_index<T, Format>(count)) return size + get_range_size<Format>(range);
+
+        size_t elements_size = 0;
+        size_t block_size = 0;
+        size_t i = 0;
+        for (auto it = traits::begin(range); it != traits::end(range); ++it) {
+            block_size += get_serialized_size<Format>(*it);
+            if (++i % range_index_stride == 0 && i != count) {
+                size += get_serialized_size_size<Format>(block_size);
+                elements_size += block_size;
+                block_size = 0;
+            }
+        }
+        elements_size += block_size;
+        return size + get_serialized_size_size<Format>(elements_size) + elements_size;
+    }
+
+    template <class Format, class T>
     constexpr size_t do_get_serialized_size(T const& container, value_tag<serialization_category::container>) noexcept {
-        return get_range_size(container) + sizeof(size_t);
+        return get_counted_range_size<Format>(container);
     }
-    template <class T>
+    template <class Format, class T>
     constexpr size_t do_get_serialized_size(T const& array, value_tag<serialization_category::fixed_array>) noexcept {
-        return get_range_size(array);
+        return get_range_size<Format>(array);
     }
-    template <class T>
+    template <class Format, class T>
     constexpr size_t do_get_serialized_size(T const& array, value_tag<serialization_category::dynamic_array>) noexcept {
-        return get_range_size(array) + sizeof(size_t);
+        return get_counted_range_size<Format>(array);
     }
-    template <class T>
+    template <class Format, class T>
+    constexpr size_t do_get_serialized_size(T const& array, value_tag<serialization_category::columnar_array>) noexcept {
+        return get_range_size<Format>(array) + get_serialized_size_size<Format>(range_traits<T>::size(array));
+    }
+    template <class Format, class T>
+    size_t do_get_serialized_size(T const& array, value_tag<serialization_category::encoded_array>) noexcept {
+        using traits = array_traits<T>;
+        auto const count = static_cast<size_t>(traits::size(array));
+        auto const size  = array_codec_t<T>::get_encoded_size(traits::data(array), count);
+        return get_serialized_size_size<Format>(count) + get_serialized_size_size<Format>(size) + size;
+    }
+    template <class Format, class T>
     constexpr size_t do_get_serialized_size(T const& value, value_tag<serialization_category::tuple>) noexcept {
-        return std::apply([] (auto&...vals) {
-            return (get_serialized_size(vals) + ... + 0);
+        if constexpr (has_bit_runs<T>()) {
+            return get_fields_size<Format, T>(value, std::make_index_sequence<get_fixed_size<T>()>{});
+        }
+        else {
+            return std::apply([] (auto&...vals) {
+                return (get_serialized_size<Format>(vals) + ... + 0);
+            }, value);
+        }
+    }
+    template <class Format, class T>
+    constexpr size_t do_get_serialized_size(T const& value, value_tag<serialization_category::optional>) noexcept {
+        return sizeof(uint8_t) + (value ? get_serialized_size<Format>(*value) : 0);
+    }
+    template <class Format, class T>
+    constexpr size_t do_get_serialized_size(T const& value, value_tag<serialization_category::variant>) noexcept {
+        return sizeof(variant_index_t<T>) + std::visit([] (auto const& alternative) {
+            return get_serialized_size<Format>(alternative);
         }, value);
     }
-    template <class T>
+    template <class Format, class T>
     constexpr size_t do_get_serialized_size(T const& value, value_tag<serialization_category::aggregate>) noexcept {
-        return get_serialized_size(as_tuple(value));
+        if constexpr (has_field_runs<T, Format>()) {
+            return get_field_steps_size<Format>(value, std::make_index_sequence<field_steps_v<T, Format>.size()>{});
+        }
+        else {
+            return get_serialized_size<Format>(as_tuple(value));
+        }
     }
 }
 
-template <class T>
+template <class Format, class T>
 constexpr size_t get_serialized_size(T const& value) noexcept {
-    return detail::do_get_serialized_size(value, serialization_category_tag_t<T>{});
+    if constexpr (has_static_serialized_size_v<T, Format>) {
+        return serialized_size_v<T, Format>;
+    }
+    else {
+        return detail::do_get_serialized_size<Format>(value, serialization_category_tag_t<T>{});
+    }
 }
 
 // deserialize
 
 namespace detail {
-    template <class T, serialization_category Category>
-    void do_deserialize(T&, span<std::byte const>&, value_tag<Category>) noexcept {
+    template <class Format, bool Checked, class T, class Buffer, serialization_category Category>
+    bool do_deserialize(T&, Buffer&, value_tag<Category>) {
         static_assert(serialization_category_v<T> != serialization_category::forbidden);
         static_assert(serialization_category_v<T> != serialization_category::unknown);
+        return false;
     }
-    template <class T>
-    void do_deserialize(T& value, span<std::byte const>& buffer, value_tag<serialization_category::trivial>) noexcept {
-        memcpy(&value, buffer.data(), sizeof(T));
-        buffer.begin() += sizeof(T);
+    template <class Format, bool Checked, class T, class Buffer>
+    bool do_deserialize(T& value, Buffer& buffer, value_tag<serialization_category::trivial>) {
+        return read_trivials<Format, Checked>(&value, 1, buffer);
     }
-    template <class T>
-    void do_deserialize(T& array, span<std::byte const>& buffer, value_tag<serialization_category::trivial_array>) {
-        size_t count;
-        deserialize(count, buffer);
+    template <class Format, bool Checked, class T, class Buffer>
+    bool do_deserialize(T& array, Buffer& buffer, value_tag<serialization_category::trivial_array>) {
+        if constexpr (is_interned<T, Format>()) {
+            return deserialize_interned<Format, Checked>(array, buffer);
+        }
+        else {
+            size_t count;
+            if (!deserialize_size<Format, Checked>(count, buffer)) return false;
+
+            using traits = dynamic_array_traits<T>;
+            using value_type = typename traits::value_type;
+            if (!is_possible_count<value_type, Format, Checked>(count, buffer)) return false;
+
+            traits::resize(array, count);
+            return read_trivials<Format, false>(traits::data(array), count, buffer);
+        }
+    }
+    template <class Format, bool Checked, class T, class Buffer>
+    bool do_deserialize(T& view, Buffer& buffer, value_tag<serialization_category::view>) {
+        if constexpr (is_interned<T, Format>()) {
+            return deserialize_interned<Format, Checked>(view, buffer);
+        }
+        else {
+            size_t count;
+            if (!deserialize_size<Format, Checked>(count, buffer)) return false;
+
+            using value_type = typename range_traits<T>::value_type;
+            using pointer    = std::remove_reference_t<decltype(array_traits<T>::data(view))>;
+            static_assert(std::is_const_v<std::remove_pointer_t<pointer>>, "Only views on const elements can be deserialized");
+            static_assert(!is_packed<value_type, Format>(), "Views can't alias packed elements");
+            static_assert(!needs_byte_swap<value_type, Format>(), "Views can't alias elements of a foreign byte order");
+
+            if (count == 0) {
+                view = T{};
+                return true;
+            }
+            if (!is_possible_count<value_type, Format, Checked>(count, buffer)) return false;
 
-        using traits = dynamic_array_traits<T>;
-        traits::resize(array, count);
+            auto const data = read_view<Checked>(count * sizeof(value_type), alignof(value_type), buffer);
+            assert(Checked || data);
+            if (!data) return false;
 
-        const auto size = count * sizeof(typename traits::value_type);
-        memcpy(traits::data(array), buffer.data(), size);
-        buffer.begin() += size;
+            view = T{ reinterpret_cast<pointer>(data), count };
+            return true;
+        }
     }
+
     template <class T>
-    void do_deserialize(T& container, span<std::byte const>& buffer, value_tag<serialization_category::container>) {
-        size_t count;
-        deserialize(count, buffer);
+    constexpr bool is_pair_v = false;
+    template <class T1, class T2>
+    constexpr bool is_pair_v<std::pair<T1, T2>> = true;
+
+    template <class Format, bool Checked, class T, class Buffer>
+    T construct_value(Buffer& buffer, bool& success);
+
+    // Converts to a value deserialized from the buffer, which is then constructed in place
+    // (the conversion result is elided). Once a conversion failed, the next ones are not read.
+    template <class Format, bool Checked, class T, class Buffer>
+    struct deserialized {
+        Buffer& buffer;
+        bool& success;
+
+        operator T() const { return construct_value<Format, Checked, T>(buffer, success); }
+    };
+
+    // Converts to the element I of a tuple of types Fields, which shares the words of bit runs
+    // with the other elements.
+    template <class Format, bool Checked, class Fields, size_t I, class Buffer>
+    struct deserialized_field {
+        using value_type = std::remove_const_t<remove_cvref_t<std::tuple_element_t<I, Fields>>>;
+
+        Buffer& buffer;
+        bool& success;
+        bit_words_t<Fields>& words;
+
+        operator value_type() const {
+            if constexpr (is_bit_packed_v<value_type>) {
+                auto value = value_type{};
+                if (!Checked || success) success = deserialize_field<Format, Checked, Fields, I>(value, words, buffer);
+                return value;
+            }
+            else {
+                return construct_value<Format, Checked, value_type>(buffer, success);
+            }
+        }
+    };
+
+    // Kept apart from construct_value, whose other return statements prevent the named return value optimization.
+    template <class Format, bool Checked, class T, class Buffer>
+    T construct_default(Buffer& buffer, bool& success) {
+        auto value = T{};
+        if (!Checked || success) success = deserialize_value<Format, Checked>(value, buffer);
+        return value;
+    }
+
+    template <class Format, bool Checked, class T, class Buffer, size_t...Is>
+    T construct_aggregate(Buffer& buffer, bool& success, std::index_sequence<Is...>) {
+        using fields = to_tuple_t<T>;
+        auto words = bit_words_t<fields>{};
+        // Braced initializers are evaluated in order.
+        return T{ deserialized_field<Format, Checked, fields, Is, Buffer>{ buffer, success, words }... };
+    }
+
+    template <class Format, bool Checked, class T, class Buffer>
+    T construct_value(Buffer& buffer, bool& success) {
+        constexpr auto category = serialization_category_v<T>;
+        constexpr auto has_const_elements = category == serialization_category::tuple && has_deep_constness_v<T>;
+        if constexpr (std::is_default_constructible_v<T> && !has_const_elements) {
+            return construct_default<Format, Checked, T>(buffer, success);
+        }
+        else if constexpr (is_pair_v<T>) {
+            auto words = bit_words_t<T>{};
+            return T{ std::piecewise_construct,
+                std::forward_as_tuple(deserialized_field<Format, Checked, T, 0, Buffer>{ buffer, success, words }),
+                std::forward_as_tuple(deserialized_field<Format, Checked, T, 1, Buffer>{ buffer, success, words }) };
+        }
+        else if constexpr (category == serialization_category::trivial) {
+            alignas(T) std::byte bytes[sizeof(T)] = {};
+            if (!Checked || success) success = read_trivials<Format, Checked>(reinterpret_cast<T*>(bytes), 1, buffer);
+            return *std::launder(reinterpret_cast<T*>(bytes));
+        }
+        else if constexpr (category == serialization_category::aggregate) {
+            return construct_aggregate<Format, Checked, T>(buffer, success, std::make_index_sequence<airity_v<T>>{});
+        }
+        else {
+            // Tuples don't construct their elements in order : they are deserialized then moved.
+            using value_type = remove_deep_constness_t<T>;
+            static_assert(std::is_default_constructible_v<value_type>, "T can't be constructed in place");
+            return T{ construct_default<Format, Checked, value_type>(buffer, success) };
+        }
+    }
+
+    template <class Format, bool Checked, class T, class Buffer>
+    bool emplace_deserialized(T& container, Buffer& buffer) {
+        using traits = container_traits<T>;
+        using value_type = typename traits::value_type;
+        auto success = true;
+        if constexpr (is_pair_v<value_type>) {
+            auto words = bit_words_t<value_type>{};
+            traits::emplace_back(container, std::piecewise_construct,
+                std::forward_as_tuple(deserialized_field<Format, Checked, value_type, 0, Buffer>{ buffer, success, words }),
+                std::forward_as_tuple(deserialized_field<Format, Checked, value_type, 1, Buffer>{ buffer, success, words }));
+        }
+        else {
+            traits::emplace_back(container, deserialized<Format, Checked, value_type, Buffer>{ buffer, success });
+        }
+        return success;
+    }
 
+    template <class Format, bool Checked, class T, class Buffer>
+    bool deserialize_elements(T& container, size_t count, Buffer& buffer) {
         using traits = container_traits<T>;
         using value_type = typename traits::value_type;
         for (size_t i = 0; i < count; ++i) {
-            if constexpr (has_deep_constness_v<value_type>) {
-                auto value = remove_deep_constness_t<value_type>{};
-                deserialize(value, buffer);
-                container_traits<T>::emplace(container, std::move(value));
+            if constexpr (has_deep_constness_v<value_type> || is_ordered_container_v<T>
+                       || !std::is_default_constructible_v<value_type>) {
+                if (!emplace_deserialized<Format, Checked>(container, buffer)) return false;
             }
             else {
-                auto& value = container_traits<T>::emplace(container);
-                deserialize(value, buffer);
+                auto& value = traits::emplace(container);
+                if (!deserialize_value<Format, Checked>(value, buffer)) return false;
             }
         }
+        return true;
     }
 
-    template <class T>
-    void deserialize_array(T& array, size_t size, span<std::byte const>& buffer) {
+    template <class Format, bool Checked, class Node, class Buffer>
+    bool deserialize_node(Node& node, Buffer& buffer) {
+        if constexpr (no_adl::has_key<Node>()) {
+            using fields = std::pair<typename Node::key_type, typename Node::mapped_type>;
+            auto words = bit_words_t<fields>{};
+            return deserialize_field<Format, Checked, fields, 0>(node.key(), words, buffer)
+                && deserialize_field<Format, Checked, fields, 1>(node.mapped(), words, buffer);
+        }
+        else {
+            return deserialize_value<Format, Checked>(node.value(), buffer);
+        }
+    }
+
+    // The blocks must lie within the elements.
+    template <class Format, bool Checked, class Buffer>
+    bool skip_range_index(size_t count, size_t elements_size, Buffer& buffer) {
+        for (size_t i = 1; i < get_blocks_count(count); ++i) {
+            size_t block_size;
+            if (!deserialize_size<Format, Checked>(block_size, buffer)) return false;
+            if (Checked && block_size > elements_size) return false;
+            elements_size -= block_size;
+        }
+        return true;
+    }
+
+    // Reads the size of the elements of an indexed range before them, and its index after them.
+    template <class Format, bool Checked, class Buffer, class F>
+    bool deserialize_indexed_range(size_t count, Buffer& buffer, F&& deserialize_elements) {
+        size_t elements_size;
+        if (!deserialize_size<Format, Checked>(elements_size, buffer)) return false;
+        if constexpr (Checked) {
+            if (buffer.size() < elements_size) return false;
+            auto const remaining = buffer.size() - elements_size;
+            if (!deserialize_elements() || buffer.size() != remaining) return false;
+        }
+        else {
+            if (!deserialize_elements()) return false;
+        }
+        return skip_range_index<Format, Checked>(count, elements_size, buffer);
+    }
+
+    // The previous elements are replaced. Their storage is reused when possible : elements of
+    // resizable containers are deserialized in place, and nodes of associative containers are
+    // extracted and refilled (the bucket array of unordered containers is still reallocated).
+    // Ordered containers were serialized sorted, so each element is inserted at the end.
+    template <class Format, bool Checked, class T, class Buffer>
+    bool deserialize_container(T& container, size_t count, Buffer& buffer) {
+        using traits = container_traits<T>;
+        using value_type = typename traits::value_type;
+
+        if constexpr (!has_deep_constness_v<value_type> && std::is_default_constructible_v<value_type>
+                   && no_adl::has_resize<T>()) {
+            container.resize(count);
+            auto it = traits::begin(container);
+            for (size_t i = 0; i < count; ++i, ++it) {
+                if (!deserialize_value<Format, Checked>(*it, buffer)) return false;
+            }
+            return true;
+        }
+        else if constexpr (is_node_container_v<T>) {
+            auto previous = std::move(container);
+            container.clear();
+            traits::try_reserve(container, get_reservable_count<value_type, Format>(count, buffer));
+
+            size_t i = 0;
+            for (; i < count && !previous.empty(); ++i) {
+                auto node = previous.extract(previous.begin());
+                if (!deserialize_node<Format, Checked>(node, buffer)) return false;
+                container.insert(container.end(), std::move(node));
+            }
+            return deserialize_elements<Format, Checked>(container, count - i, buffer);
+        }
+        else {
+            container.clear();
+            traits::try_reserve(container, get_reservable_count<value_type, Format>(count, buffer));
+            return deserialize_elements<Format, Checked>(container, count, buffer);
+        }
+    }
+    template <class Format, bool Checked, class T, class Buffer>
+    bool do_deserialize(T& container, Buffer& buffer, value_tag<serialization_category::container>) {
+        size_t count;
+        if (!deserialize_size<Format, Checked>(count, buffer)) return false;
+
+        using value_type = typename container_traits<T>::value_type;
+        if (!is_possible_count<value_type, Format, Checked>(count, buffer)) return false;
+
+        if (has_range_index<T, Format>(count)) {
+            return deserialize_indexed_range<Format, Checked>(count, buffer, [&] {
+                return deserialize_container<Format, Checked>(container, count, buffer);
+            });
+        }
+        return deserialize_container<Format, Checked>(container, count, buffer);
+    }
+
+    template <class Format, bool Checked, class T, class Buffer>
+    bool deserialize_array(T& array, size_t size, Buffer& buffer) {
         auto const data = array_traits<T>::data(array);
         for (auto ptr = data; ptr < data + size; ++ptr) {
-            deserialize(*ptr, buffer);
+            if (!deserialize_value<Format, Checked>(*ptr, buffer)) return false;
         }
+        return true;
     }
 
-    template <class T>
-    void do_deserialize(T& array, span<std::byte const>& buffer, value_tag<serialization_category::fixed_array>) {
-        deserialize_array(array, get_fixed_size<T>(), buffer);
+    template <class Format, bool Checked, class T, class Buffer>
+    bool do_deserialize(T& array, Buffer& buffer, value_tag<serialization_category::fixed_array>) {
+        return deserialize_array<Format, Checked>(array, get_fixed_size<T>(), buffer);
     }
-    template <class T>
-    void do_deserialize(T& array, span<std::byte const>& buffer, value_tag<serialization_category::dynamic_array>) {
+    template <class Format, bool Checked, class T, class Buffer>
+    bool do_deserialize(T& array, Buffer& buffer, value_tag<serialization_category::dynamic_array>) {
         size_t count;
-        deserialize(count, buffer);
+        if (!deserialize_size<Format, Checked>(count, buffer)) return false;
+
+        using value_type = typename range_traits<T>::value_type;
+        if (!is_possible_count<value_type, Format, Checked>(count, buffer)) return false;
 
         dynamic_array_traits<T>::resize(array, count);
-        deserialize_array(array, count, buffer);
+        if (has_range_index<T, Format>(count)) {
+            return deserialize_indexed_range<Format, Checked>(count, buffer, [&] {
+                return deserialize_array<Format, Checked>(array, count, buffer);
+            });
+        }
+        return deserialize_array<Format, Checked>(array, count, buffer);
     }
-    template <class T>
-    void do_deserialize(T& value, span<std::byte const>& buffer, value_tag<serialization_category::tuple>) {
-        std::apply([&] (auto&...vals) {
-            (deserialize(vals, buffer), ...);
-        }, value);
+
+    template <class Format, bool Checked, size_t I, class T, class Buffer>
+    bool deserialize_column(T& array, Buffer& buffer) {
+        using traits = array_traits<T>;
+        using field  = std::tuple_element_t<I, field_types_t<typename traits::value_type>>;
+        auto const data  = traits::data(array);
+        auto const count = static_cast<size_t>(traits::size(array));
+
+        if constexpr (Checked && serialization_category_v<field> == serialization_category::trivial) {
+            if (buffer.size() / get_trivial_size<field, Format>() < count) return false;
+            return deserialize_column<Format, false, I>(array, buffer);
+        }
+        else {
+            for (auto row = data; row != data + count; ++row) {
+                if (!deserialize_value<Format, Checked>(std::get<I>(as_tuple(*row)), buffer)) return false;
+            }
+            return true;
+        }
     }
-    template <class T>
-    void do_deserialize(T& value, span<std::byte const>& buffer, value_tag<serialization_category::aggregate>) {
+    template <class Format, bool Checked, class T, class Buffer, size_t...Is>
+    bool deserialize_columns(T& array, Buffer& buffer, std::index_sequence<Is...>) {
+        return (deserialize_column<Format, Checked, Is>(array, buffer) && ...);
+    }
+    template <class Format, bool Checked, class T, class Buffer>
+    bool do_deserialize(T& array, Buffer& buffer, value_tag<serialization_category::columnar_array>) {
+        size_t count;
+        if (!deserialize_size<Format, Checked>(count, buffer)) return false;
+
+        using value_type = typename range_traits<T>::value_type;
+        if (!is_possible_count<value_type, Format, Checked>(count, buffer)) return false;
+
+        dynamic_array_traits<T>::resize(array, count);
+        return deserialize_columns<Format, Checked>(array, buffer, std::make_index_sequence<airity_v<value_type>>{});
+    }
+    template <class Format, bool Checked, class T, class Buffer>
+    bool do_deserialize(T& array, Buffer& buffer, value_tag<serialization_category::encoded_array>) {
+        using codec = array_codec_t<T>;
+        size_t count, size;
+        if (!deserialize_size<Format, Checked>(count, buffer) || !deserialize_size<Format, Checked>(size, buffer)) return false;
+        if constexpr (Checked) {
+            if (buffer.size() < size || !codec::is_possible_count(count, size)) return false;
+        }
+        dynamic_array_traits<T>::resize(array, count);
+        auto const values = array_traits<T>::data(array);
+
+        if constexpr (is_span_source_v<Buffer>) {
+            auto const data = span<std::byte const>{ buffer.data(), size };
+            if (!codec::decode(values, count, data)) return false;
+            buffer.begin() += size;
+            return true;
+        }
+        else {
+            // The bytes are copied out of the source into a buffer kept by the thread, which
+            // only grows : steady reads don't allocate.
+            thread_local auto bytes = std::vector<std::byte>{};
+            if (bytes.size() < size) bytes.resize(size);
+            if (!read_bytes<Checked>(bytes.data(), size, buffer)) return false;
+            return codec::decode(values, count, span<std::byte const>{ bytes.data(), size });
+        }
+    }
+    template <class Format, bool Checked, class T, class Buffer>
+    bool do_deserialize(T& value, Buffer& buffer, value_tag<serialization_category::bit_packed>) {
+        auto tuple = std::tie(value);
+        return deserialize_fields<Format, Checked, std::tuple<T>>(tuple, buffer, std::index_sequence<0>{});
+    }
+    template <class Format, bool Checked, class T, class Buffer>
+    bool do_deserialize(T& value, Buffer& buffer, value_tag<serialization_category::tuple>) {
+        if constexpr (has_bit_runs<T>()) {
+            return deserialize_fields<Format, Checked, T>(value, buffer, std::make_index_sequence<get_fixed_size<T>()>{});
+        }
+        else {
+            return std::apply([&] (auto&...vals) {
+                return (deserialize_value<Format, Checked>(vals, buffer) && ...);
+            }, value);
+        }
+    }
+    template <class Format, bool Checked, class T, class Buffer>
+    bool do_deserialize(T& value, Buffer& buffer, value_tag<serialization_category::optional>) {
+        using value_type = typename T::value_type;
+        uint8_t flag;
+        if (!read_bytes<Checked>(&flag, sizeof(flag), buffer)) return false;
+        if (Checked && flag > 1) return false;
+        if (flag == 0) {
+            value.reset();
+            return true;
+        }
+        if constexpr (std::is_default_constructible_v<value_type>) {
+            if (!value) value.emplace();
+            return deserialize_value<Format, Checked>(*value, buffer);
+        }
+        else {
+            auto success = true;
+            value.emplace(deserialized<Format, Checked, value_type, Buffer>{ buffer, success });
+            return success;
+        }
+    }
+
+    // The storage of the previous alternative is reused when it is the same.
+    template <class Format, bool Checked, class T, size_t I, class Buffer>
+    bool deserialize_alternative(T& value, Buffer& buffer) {
+        using alternative = std::variant_alternative_t<I, T>;
+        if constexpr (std::is_default_constructible_v<alternative>) {
+            if (value.index() != I) value.template emplace<I>();
+            return deserialize_value<Format, Checked>(*std::get_if<I>(&value), buffer);
+        }
+        else {
+            auto success = true;
+            value.template emplace<I>(deserialized<Format, Checked, alternative, Buffer>{ buffer, success });
+            return success;
+        }
+    }
+    // Alternatives are deserialized through a table of functions, indexed by the discriminant.
+    template <class Format, bool Checked, class T, class Buffer, size_t...Is>
+    bool deserialize_alternative(T& value, size_t index, Buffer& buffer, std::index_sequence<Is...>) {
+        constexpr bool (*alternatives[])(T&, Buffer&) = { &deserialize_alternative<Format, Checked, T, Is, Buffer>... };
+        return alternatives[index](value, buffer);
+    }
+    template <class Format, bool Checked, class T, class Buffer>
+    bool do_deserialize(T& value, Buffer& buffer, value_tag<serialization_category::variant>) {
+        variant_index_t<T> index;
+        if (!read_trivials<Format, Checked>(&index, 1, buffer)) return false;
+        if (Checked && index >= std::variant_size_v<T>) return false;
+        return deserialize_alternative<Format, Checked>(value, index, buffer, std::make_index_sequence<std::variant_size_v<T>>{});
+    }
+    template <class Format, bool Checked, class T, class Buffer>
+    bool do_deserialize(T& value, Buffer& buffer, value_tag<serialization_category::aggregate>) {
+        if constexpr (has_field_runs<T, Format>()) {
+            if (has_computed_offsets<T, airity_v<T>>(value)) {
+                return deserialize_field_steps<Format, Checked>(value, buffer, std::make_index_sequence<field_steps_v<T, Format>.size()>{});
+            }
+        }
         auto tuple = as_tuple(value);
-        deserialize(tuple, buffer);
+        return deserialize_value<Format, Checked>(tuple, buffer);
+    }
+
+    template <class Format, bool Checked, class T, class Buffer>
+    bool deserialize_value(T& value, Buffer& buffer) {
+        // Values of static size are checked once, then read without branches.
+        if constexpr (Checked && is_checked_by_size_v<T, Format>) {
+            if (buffer.size() < serialized_size_v<T, Format>) return false;
+            return do_deserialize<Format, false>(value, buffer, serialization_category_tag_t<T>{});
+        }
+        else {
+            return do_deserialize<Format, Checked>(value, buffer, serialization_category_tag_t<T>{});
+        }
     }
 }
 
-template <class T>
-void deserialize(T& value, span<std::byte const>& buffer) {
-    detail::do_deserialize(value, buffer, serialization_category_tag_t<T>{});
+template <class Format, class T, class Buffer>
+void deserialize(T& value, Buffer& buffer) {
+    detail::deserialize_value<Format, false>(value, buffer);
+}
+
+namespace detail {
+    // Restores the buffer when the deserialization fails.
+    template <class Format, class T, class Buffer>
+    bool try_deserialize_value(T& value, Buffer& buffer) {
+        if constexpr (is_span_source_v<Buffer>) {
+            auto const begin = buffer.begin();
+            auto const strings = get_strings_count(buffer);
+            if (!deserialize_value<Format, true>(value, buffer)) {
+                buffer.begin() = begin;
+                forget_strings(buffer, strings);
+                return false;
+            }
+        }
+        else {
+            auto const position = buffer;
+            if (!deserialize_value<Format, true>(value, buffer)) {
+                buffer = position;
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+template <class Format, class T, class Buffer>
+bool try_deserialize(T& value, Buffer& buffer) {
+    // Spans are checked before values of static size are written. Other values are read into
+    // a temporary, moved into the value once they are complete.
+    constexpr auto is_checked_first = is_span_source_v<Buffer> && detail::is_checked_by_size_v<T, Format>;
+    if constexpr (!is_checked_first && std::is_default_constructible_v<T> && std::is_move_assignable_v<T>) {
+        auto result = T{};
+        if (!detail::try_deserialize_value<Format>(result, buffer)) return false;
+        value = std::move(result);
+        return true;
+    }
+    else {
+        return detail::try_deserialize_value<Format>(value, buffer);
+    }
+}
+
+template <class T, class Format, class Buffer>
+T deserialize(Buffer& buffer) {
+    auto success = true;
+    return detail::construct_value<Format, false, T>(buffer, success);
 }
 
 // try_get_deserialized_size
 
 namespace detail {
-    template <class T, serialization_category Category>
+    template <class T, class Format, serialization_category Category>
     void do_try_get_deserialized_size(span<std::byte const>, value_tag<Category>) noexcept {
         static_assert(serialization_category_v<T> != serialization_category::forbidden);
         static_assert(serialization_category_v<T> != serialization_category::unknown);
     }
-    template <class T>
+    template <class T, class Format>
     std::pair<size_t, bool> do_try_get_deserialized_size(span<std::byte const> buffer, value_tag<serialization_category::trivial>) noexcept {
-        return { sizeof(T), buffer.size() >= sizeof(T) };
+        constexpr auto size = get_trivial_size<T, Format>();
+        return { size, buffer.size() >= size };
     }
 
-    template <class T>
+    template <class T, class Format>
     std::pair<size_t, bool> try_get_range_size(span<std::byte const> buffer) noexcept {
-        auto const data_begin = buffer.begin();
-
-        size_t count;
-        if (buffer.size() < sizeof(count)) return { {}, false };
-        deserialize(count, buffer);
-        
-        using value_type = typename range_traits<T>::value_type;
-        if constexpr (serialization_category_v<value_type> == serialization_category::trivial) {
-            auto const elements_size = count * sizeof(value_type);
-            if (buffer.size() < elements_size) return { {}, false };
-            buffer.begin() += elements_size;
+        if constexpr (is_interned<T, Format>()) {
+            return try_get_interned_size<Format>(buffer);
         }
         else {
-            for (size_t i = 0; i < count; ++i) {
-                auto const [size, success] = try_get_deserialized_size<value_type>(buffer);
-                if (!success) return { {}, false };
-                buffer.begin() += size;
+            auto const data_begin = buffer.begin();
+
+            size_t count;
+            if (!deserialize_size<Format, true>(count, buffer)) return { {}, false };
+
+            auto const is_indexed = has_range_index<T, Format>(count);
+            size_t indexed_size = 0;
+            if (is_indexed && (!deserialize_size<Format, true>(indexed_size, buffer) || buffer.size() < indexed_size)) return { {}, false };
+            auto const elements_begin = buffer.begin();
+
+            using value_type = typename range_traits<T>::value_type;
+            if constexpr (serialization_category_v<value_type> == serialization_category::trivial) {
+                if (count > buffer.size() / get_trivial_size<value_type, Format>()) return { {}, false };
+                auto const elements_size = count * get_trivial_size<value_type, Format>();
+                buffer.begin() += elements_size;
+            }
+            else {
+                for (size_t i = 0; i < count; ++i) {
+                    auto const [size, success] = try_get_deserialized_size<value_type, Format>(buffer);
+                    if (!success) return { {}, false };
+                    buffer.begin() += size;
+                }
+            }
+            if (is_indexed) {
+                if (static_cast<size_t>(buffer.begin() - elements_begin) != indexed_size) return { {}, false };
+                if (!skip_range_index<Format, true>(count, indexed_size, buffer)) return { {}, false };
             }
+            return { buffer.begin() - data_begin, true };
         }
-        return { buffer.begin() - data_begin, true };
     }
 
-    template <class T>
+    template <class T, class Format>
     std::pair<size_t, bool> do_try_get_deserialized_size(span<std::byte const> buffer, value_tag<serialization_category::trivial_array>) noexcept {
-        return try_get_range_size<T>(buffer);
+        return try_get_range_size<T, Format>(buffer);
     }
-    template <class T>
+    template <class T, class Format>
+    std::pair<size_t, bool> do_try_get_deserialized_size(span<std::byte const> buffer, value_tag<serialization_category::view>) noexcept {
+        return try_get_range_size<T, Format>(buffer);
+    }
+    template <class T, class Format>
     std::pair<size_t, bool> do_try_get_deserialized_size(span<std::byte const> buffer, value_tag<serialization_category::container>) noexcept {
-        return try_get_range_size<T>(buffer);
+        return try_get_range_size<T, Format>(buffer);
     }
-    template <class T>
+    template <class T, class Format>
     std::pair<size_t, bool> do_try_get_deserialized_size(span<std::byte const> buffer, value_tag<serialization_category::fixed_array>) noexcept {
         auto const data_begin = buffer.begin();
 
         using value_type = typename range_traits<T>::value_type;
         for (size_t i = 0; i < get_fixed_size<T>(); ++i) {
-             auto const [size, success] = try_get_deserialized_size<value_type>(buffer);
+             auto const [size, success] = try_get_deserialized_size<value_type, Format>(buffer);
             if (!success) return { {}, false };
             buffer.begin() += size;
         }
         return { buffer.begin() - data_begin, true };
     }
-    template <class T>
+    template <class T, class Format>
     std::pair<size_t, bool> do_try_get_deserialized_size(span<std::byte const> buffer, value_tag<serialization_category::dynamic_array>) noexcept {
-        return try_get_range_size<T>(buffer);
+        return try_get_range_size<T, Format>(buffer);
     }
-    template <class T>
+    template <class T, class Format, size_t...Is>
+    std::pair<size_t, bool> try_get_columns_size(span<std::byte const> buffer, std::index_sequence<Is...>) noexcept {
+        auto const data_begin = buffer.begin();
+
+        size_t count;
+        if (!deserialize_size<Format, true>(count, buffer)) return { {}, false };
+
+        using value_type = typename range_traits<T>::value_type;
+        if (!is_possible_count<value_type, Format, true>(count, buffer)) return { {}, false };
+
+        auto const try_column = [&] (auto tag) {
+            using field = typename decltype(tag)::type;
+            if constexpr (serialization_category_v<field> == serialization_category::trivial) {
+                if (count > buffer.size() / get_trivial_size<field, Format>()) return false;
+                buffer.begin() += count * get_trivial_size<field, Format>();
+            }
+            else {
+                for (size_t i = 0; i < count; ++i) {
+                    auto const [size, success] = try_get_deserialized_size<field, Format>(buffer);
+                    if (!success) return false;
+                    buffer.begin() += size;
+                }
+            }
+            return true;
+        };
+        using fields = field_types_t<value_type>;
+        auto const success = (try_column(type_tag<std::tuple_element_t<Is, fields>>{}) && ...);
+        return { buffer.begin() - data_begin, success };
+    }
+    template <class T, class Format>
+    std::pair<size_t, bool> do_try_get_deserialized_size(span<std::byte const> buffer, value_tag<serialization_category::columnar_array>) noexcept {
+        using value_type = typename range_traits<T>::value_type;
+        return try_get_columns_size<T, Format>(buffer, std::make_index_sequence<airity_v<value_type>>{});
+    }
+    template <class T, class Format>
+    std::pair<size_t, bool> do_try_get_deserialized_size(span<std::byte const> buffer, value_tag<serialization_category::encoded_array>) noexcept {
+        using codec      = array_codec_t<T>;
+        using value_type = typename range_traits<T>::value_type;
+        auto const data_begin = buffer.begin();
+
+        size_t count, size;
+        if (!deserialize_size<Format, true>(count, buffer) || !deserialize_size<Format, true>(size, buffer)) return { {}, false };
+        if (buffer.size() < size || !codec::is_possible_count(count, size)) return { {}, false };
+        if (!codec::template validate<value_type>(count, span<std::byte const>{ buffer.data(), size })) return { {}, false };
+
+        return { buffer.begin() + size - data_begin, true };
+    }
+    template <class T, class Format>
+    std::pair<size_t, bool> do_try_get_deserialized_size(span<std::byte const> buffer, value_tag<serialization_category::bit_packed>) noexcept {
+        auto const data_begin = buffer.begin();
+        auto const success = try_get_fields_size<Format, std::tuple<T>>(buffer, std::index_sequence<0>{});
+        return { buffer.begin() - data_begin, success };
+    }
+    template <class T, class Format>
     std::pair<size_t, bool> do_try_get_deserialized_size(span<std::byte const> buffer, value_tag<serialization_category::tuple>) noexcept {
-        return std::apply([&] (auto...tags) {
+        if constexpr (has_bit_runs<T>()) {
             auto const data_begin = buffer.begin();
-            auto const try_one    = [&] (auto tag) {
-                using value_type = remove_deep_constness_t<typename decltype(tag)::type>;
-                auto const [size, success] = try_get_deserialized_size<value_type>(buffer);
-                if (!success) return false;
-                buffer.begin() += size;
-                return true;
-            };
-            auto const success = (try_one(tags) && ...);
-            return std::pair<size_t, bool>{ buffer.begin() - data_begin, success };
-        }, map_tuple_types_t<T, tag_type>{});
+            auto const success = try_get_fields_size<Format, T>(buffer, std::make_index_sequence<get_fixed_size<T>()>{});
+            return { buffer.begin() - data_begin, success };
+        }
+        else {
+            return std::apply([&] (auto...tags) {
+                auto const data_begin = buffer.begin();
+                auto const try_one    = [&] (auto tag) {
+                    using value_type = remove_deep_constness_t<typename decltype(tag)::type>;
+                    auto const [size, success] = try_get_deserialized_size<value_type, Format>(buffer);
+                    if (!success) return false;
+                    buffer.begin() += size;
+                    return true;
+                };
+                auto const success = (try_one(tags) && ...);
+                return std::pair<size_t, bool>{ buffer.begin() - data_begin, success };
+            }, map_tuple_types_t<T, tag_type>{});
+        }
     }
-    template <class T>
+    template <class T, class Format>
+    std::pair<size_t, bool> do_try_get_deserialized_size(span<std::byte const> buffer, value_tag<serialization_category::optional>) noexcept {
+        uint8_t flag;
+        if (!read_bytes<true>(&flag, sizeof(flag), buffer) || flag > 1) return { {}, false };
+        if (flag == 0) return { sizeof(flag), true };
+        auto const [size, success] = try_get_deserialized_size<remove_deep_constness_t<typename T::value_type>, Format>(buffer);
+        return { sizeof(flag) + size, success };
+    }
+    template <class T, class Format, size_t...Is>
+    std::pair<size_t, bool> try_get_alternative_size(size_t index, span<std::byte const> buffer, std::index_sequence<Is...>) noexcept {
+        constexpr std::pair<size_t, bool> (*alternatives[])(span<std::byte const>) noexcept = {
+            &try_get_deserialized_size<std::variant_alternative_t<Is, T>, Format>... };
+        return alternatives[index](buffer);
+    }
+    template <class T, class Format>
+    std::pair<size_t, bool> do_try_get_deserialized_size(span<std::byte const> buffer, value_tag<serialization_category::variant>) noexcept {
+        variant_index_t<T> index;
+        if (!read_trivials<Format, true>(&index, 1, buffer) || index >= std::variant_size_v<T>) return { {}, false };
+        auto const [size, success] = try_get_alternative_size<T, Format>(index, buffer, std::make_index_sequence<std::variant_size_v<T>>{});
+        return { sizeof(index) + size, success };
+    }
+    template <class T, class Format>
     std::pair<size_t, bool> do_try_get_deserialized_size(span<std::byte const> buffer, value_tag<serialization_category::aggregate>) noexcept {
-        using tuple_t = decltype(to_tuple(std::declval<T>()));
-        return try_get_deserialized_size<tuple_t>(buffer);
+        if constexpr (has_field_runs<T, Format>()) {
+            return try_get_field_steps_size<T, Format>(buffer, std::make_index_sequence<field_steps_v<T, Format>.size()>{});
+        }
+        else {
+            using tuple_t = decltype(to_tuple(std::declval<T>()));
+            return try_get_deserialized_size<tuple_t, Format>(buffer);
+        }
     }
 }
 
-template <class T>
+template <class T, class Format>
 std::pair<size_t, bool> try_get_deserialized_size(span<std::byte const> buffer) noexcept {
-    return detail::do_try_get_deserialized_size<T>(buffer, serialization_category_tag_t<T>{});
+    if constexpr (detail::is_checked_by_size_v<T, Format>) {
+        constexpr auto size = serialized_size_v<T, Format>;
+        return { size, buffer.size() >= size };
+    }
+    else {
+        return detail::do_try_get_deserialized_size<T, Format>(buffer, serialization_category_tag_t<T>{});
+    }
 }
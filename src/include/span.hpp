@@ -9,6 +9,11 @@ class span {
     T* begin_;
     T* end_;
 public:
+    span() noexcept :
+        begin_{ nullptr },
+        end_  { nullptr }
+    {}
+
     template <class Array, class = std::enable_if_t<
         is_array_v<Array>
     >>
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <span.hpp>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Strings already written in a message, mapped to their index in order of appearance.
+// The strings are referenced where they were written in the output buffer.
+class string_interner {
+    std::unordered_map<std::string_view, size_t> indices_;
+    std::vector<std::string_view> strings_;
+public:
+    size_t size() const noexcept { return strings_.size(); }
+
+    // Returns the index of the string, or size() if it wasn't interned.
+    size_t find(std::string_view str) const noexcept {
+        auto const it = indices_.find(str);
+        return it == indices_.end() ? size() : it->second;
+    }
+    void intern(std::string_view str) {
+        indices_.emplace(str, strings_.size());
+        strings_.push_back(str);
+    }
+
+    // Forgets the strings interned after the first size ones.
+    void truncate(size_t size) {
+        for (auto i = size; i < strings_.size(); ++i) indices_.erase(strings_[i]);
+        strings_.resize(size);
+    }
+    void clear() noexcept {
+        indices_.clear();
+        strings_.clear();
+    }
+};
+
+// Strings already read in a message, in order of appearance.
+// The strings are referenced where they were read in the input buffer.
+class string_table {
+    std::vector<std::string_view> strings_;
+public:
+    size_t size() const noexcept { return strings_.size(); }
+
+    std::string_view operator[](size_t index) const noexcept { return strings_[index]; }
+
+    void intern(std::string_view str) {
+        strings_.push_back(str);
+    }
+
+    // Forgets the strings read after the first size ones.
+    void truncate(size_t size) {
+        strings_.resize(size);
+    }
+    void clear() noexcept {
+        strings_.clear();
+    }
+};
+
+// Span buffer which keeps the dictionary of the strings of the message, for interned formats.
+// Clear the dictionary between messages : the strings reference the buffer.
+template <class T>
+class interning_span : public span<T> {
+    using dictionary_type = std::conditional_t<std::is_const_v<T>, string_table, string_interner>;
+    dictionary_type strings_;
+public:
+    using span<T>::span;
+
+    auto&       strings()       noexcept { return strings_; }
+    auto const& strings() const noexcept { return strings_; }
+};
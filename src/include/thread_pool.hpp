@@ -0,0 +1,82 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads running the tasks of one batch at a time. The calling thread
+// takes tasks too, so a pool of size 1 has no worker and runs the batch inline.
+class thread_pool {
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    void (*invoke_)(void const*, size_t) = nullptr;
+    void const* task_ = nullptr;
+    size_t next_    = 0; // Next task to take.
+    size_t count_   = 0; // Number of tasks of the batch.
+    size_t pending_ = 0; // Tasks not finished yet.
+    uint64_t batch_ = 0;
+    bool stopping_  = false;
+
+    // Takes and runs the tasks of the current batch until there are none left.
+    void run_tasks(std::unique_lock<std::mutex>& lock) {
+        while (next_ < count_) {
+            auto const index = next_++;
+            auto const invoke = invoke_;
+            auto const task   = task_;
+            lock.unlock();
+            invoke(task, index);
+            lock.lock();
+            if (--pending_ == 0) done_.notify_all();
+        }
+    }
+    void work() {
+        auto lock = std::unique_lock<std::mutex>{ mutex_ };
+        uint64_t batch = 0;
+        for (;;) {
+            wake_.wait(lock, [&] { return stopping_ || batch_ != batch; });
+            if (stopping_) return;
+            batch = batch_;
+            run_tasks(lock);
+        }
+    }
+public:
+    // Uses one thread per core by default.
+    explicit thread_pool(size_t size = std::thread::hardware_concurrency()) {
+        for (size_t i = 1; i < size; ++i) workers_.emplace_back([this] { work(); });
+    }
+    ~thread_pool() {
+        {
+            auto const lock = std::lock_guard<std::mutex>{ mutex_ };
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        for (auto& worker : workers_) worker.join();
+    }
+    thread_pool(thread_pool const&) = delete;
+    thread_pool& operator=(thread_pool const&) = delete;
+
+    // Number of threads running the tasks, the calling one included.
+    size_t size() const noexcept { return workers_.size() + 1; }
+
+    // Calls task(i) for i in [0, count) on the threads of the pool, and returns once they all
+    // returned. The tasks must not throw, nor run batches on the same pool.
+    template <class F>
+    void run(size_t count, F const& task) {
+        if (count == 0) return;
+        auto lock = std::unique_lock<std::mutex>{ mutex_ };
+        invoke_ = [] (void const* task, size_t index) { (*static_cast<F const*>(task))(index); };
+        task_    = &task;
+        next_    = 0;
+        count_   = count;
+        pending_ = count;
+        ++batch_;
+        wake_.notify_all();
+        run_tasks(lock);
+        done_.wait(lock, [&] { return pending_ == 0; });
+    }
+};
@@ -9,6 +9,10 @@
 
 template <class T>
 using remove_cvref_t = std::remove_cv_t<std::remove_reference_t<T>>;
+template <class T>
+struct remove_cvref {
+    using type = remove_cvref_t<T>;
+};
 
 template <class T>
 struct always_false : std::false_type {};
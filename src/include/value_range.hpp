@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+// Values of types with a range are bit packed : they are written on the bits needed for
+// max - min, and the adjacent ones in tuples and aggregates share the same bytes.
+// Specialize value_range for an enum or an integer type, with the bounds of its values :
+//   template <> struct value_range<color> {
+//       static constexpr auto min = color::red;
+//       static constexpr auto max = color::blue;
+//   };
+// or declare fields with the ranged wrapper. Values out of their range fail checked reads.
+template <class T>
+struct value_range {};
+
+// Value of T within [Min, Max], where T is an integer, an enum or bool.
+template <class T, T Min, T Max>
+struct ranged {
+    static_assert(std::is_integral_v<T> || std::is_enum_v<T>, "Only integers and enums have a range");
+    static_assert(!(Max < Min), "The range is empty");
+
+    T value = Min;
+
+    constexpr ranged() noexcept = default;
+    constexpr ranged(T value) noexcept : value{ value } {}
+
+    constexpr operator T() const noexcept { return value; }
+};
+
+template <class T, T Min, T Max>
+struct value_range<ranged<T, Min, Max>> {
+    static constexpr T min = Min;
+    static constexpr T max = Max;
+};
+
+using packed_bool = ranged<bool, false, true>;
+
+template <class T, class SFINAE = void>
+constexpr bool is_bit_packed_v = false;
+template <class T>
+constexpr bool is_bit_packed_v<T, std::void_t<decltype(value_range<T>::min), decltype(value_range<T>::max)>> = true;
+
+namespace detail::bits {
+    template <class T>
+    using range_value_t = std::remove_cv_t<decltype(value_range<T>::min)>;
+
+    template <class T>
+    constexpr auto to_integer(T value) noexcept {
+        if constexpr (std::is_enum_v<T>) return static_cast<std::underlying_type_t<T>>(value);
+        else return value;
+    }
+    // Negative values are sign extended, and differences are computed modulo 2^64.
+    template <class T>
+    constexpr uint64_t to_word(T value) noexcept {
+        return static_cast<uint64_t>(to_integer(value));
+    }
+
+    // Largest offset of a value from the range minimum.
+    template <class T>
+    constexpr uint64_t range_span_v = to_word(value_range<T>::max) - to_word(value_range<T>::min);
+
+    template <class T>
+    constexpr unsigned width_v = [] {
+        unsigned width = 0;
+        for (auto span = range_span_v<T>; span != 0; span >>= 1) ++width;
+        return width;
+    }();
+
+    template <class T>
+    constexpr uint64_t mask_v = width_v<T> == 64 ? ~uint64_t{ 0 } : (uint64_t{ 1 } << width_v<T>) - 1;
+
+    // True when all the patterns of width_v<T> bits are values of the range.
+    template <class T>
+    constexpr bool is_exhaustive_v = range_span_v<T> == mask_v<T>;
+
+    template <class T>
+    constexpr uint64_t to_bits(T const& value) noexcept {
+        using R = range_value_t<T>;
+        return to_word(static_cast<R>(value)) - to_word(value_range<T>::min);
+    }
+    // The bits are masked to width_v<T>. Fails when they are out of the range.
+    template <bool Checked, class T>
+    constexpr bool from_bits(T& value, uint64_t bits) noexcept {
+        using R = range_value_t<T>;
+        using I = decltype(to_integer(std::declval<R>()));
+        if constexpr (Checked && !is_exhaustive_v<T>) {
+            if (bits > range_span_v<T>) return false;
+        }
+        value = static_cast<T>(static_cast<R>(static_cast<I>(bits + to_word(value_range<T>::min))));
+        return true;
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <span.hpp>
+#include <cstdint>
+
+// LEB128 unsigned integers : 7 bits per byte, least significant group first,
+// the high bit of each byte tells if another byte follows.
+
+constexpr size_t max_varint_size = (64 + 6) / 7;
+
+constexpr size_t get_varint_size(uint64_t value) noexcept {
+    size_t size = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        ++size;
+    }
+    return size;
+}
+
+inline void write_varint(uint64_t value, span<std::byte>& buffer) noexcept {
+    auto ptr = buffer.data();
+    while (value >= 0x80) {
+        *ptr++ = static_cast<std::byte>(value | 0x80);
+        value >>= 7;
+    }
+    *ptr++ = static_cast<std::byte>(value);
+    buffer.begin() = ptr;
+}
+
+inline uint64_t read_varint(span<std::byte const>& buffer) noexcept {
+    auto ptr = buffer.data();
+    uint64_t value = 0;
+    for (int shift = 0;; shift += 7) {
+        auto const byte = static_cast<uint64_t>(*ptr++);
+        value |= (byte & 0x7F) << shift;
+        if (byte < 0x80) break;
+    }
+    buffer.begin() = ptr;
+    return value;
+}
+
+// Fails on truncated input and on encodings which don't fit in 64 bits.
+// The buffer is only advanced on success.
+inline bool try_read_varint(uint64_t& value, span<std::byte const>& buffer) noexcept {
+    auto const size = buffer.size() < max_varint_size ? buffer.size() : max_varint_size;
+    auto const data = buffer.data();
+
+    uint64_t result = 0;
+    for (size_t i = 0; i < size; ++i) {
+        auto const byte = static_cast<uint64_t>(data[i]);
+        if (i == max_varint_size - 1 && byte > 1) return false;
+
+        result |= (byte & 0x7F) << (7 * i);
+        if (byte < 0x80) {
+            value = result;
+            buffer.begin() += i + 1;
+            return true;
+        }
+    }
+    return false;
+}
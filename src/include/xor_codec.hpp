@@ -0,0 +1,248 @@
+#pragma once
+
+#include <span.hpp>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Floating point values are encoded as the xor of their bits with the previous value, as in
+// the Gorilla time series database. Consecutive values of a series share their sign, exponent
+// and high mantissa bits, so the xor is mostly zeros and only its meaningful bits are written :
+//   '0'                                           same value as the previous one
+//   '10' meaningful bits                          within the previous leading and trailing zeros
+//   '11' leading zeros, length - 1, meaningful bits
+// The first value is written as is. Zero counts take 5 bits for floats and 6 bits for doubles.
+// Bits are written from the lowest ones of each byte.
+
+namespace detail::xor_bits {
+    template <class T>
+    using word_t = std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>;
+    template <class U>
+    constexpr unsigned word_bits = sizeof(U) * 8;
+    template <class U>
+    constexpr unsigned count_bits = sizeof(U) == 4 ? 5 : 6;
+
+    inline unsigned count_leading_zeros(uint64_t value, unsigned bits) noexcept {
+#if defined(__GNUC__)
+        return static_cast<unsigned>(__builtin_clzll(value)) - (64 - bits);
+#else
+        unsigned count = 0;
+        for (auto mask = uint64_t{ 1 } << (bits - 1); (value & mask) == 0; mask >>= 1) ++count;
+        return count;
+#endif
+    }
+    inline unsigned count_trailing_zeros(uint64_t value) noexcept {
+#if defined(__GNUC__)
+        return static_cast<unsigned>(__builtin_ctzll(value));
+#else
+        unsigned count = 0;
+        for (; (value & 1) == 0; value >>= 1) ++count;
+        return count;
+#endif
+    }
+
+    class bit_writer {
+        std::byte* data_;
+        uint64_t bits_ = 0;
+        unsigned filled_ = 0;
+
+        void flush(unsigned bytes) noexcept {
+            for (unsigned i = 0; i < bytes; ++i) data_[i] = static_cast<std::byte>(bits_ >> (8 * i));
+            data_ += bytes;
+        }
+    public:
+        explicit bit_writer(std::byte* data) noexcept : data_{ data } {}
+
+        // The value holds at most count bits, with count <= 64.
+        void write(uint64_t value, unsigned count) noexcept {
+            bits_ |= value << filled_;
+            if (filled_ + count < 64) {
+                filled_ += count;
+                return;
+            }
+            flush(8);
+            bits_ = filled_ == 0 ? 0 : value >> (64 - filled_);
+            filled_ = filled_ + count - 64;
+        }
+        void finish() noexcept {
+            flush((filled_ + 7) / 8);
+        }
+    };
+
+    class bit_counter {
+        size_t count_ = 0;
+    public:
+        void write(uint64_t, unsigned count) noexcept { count_ += count; }
+        void finish() noexcept {}
+        size_t size() const noexcept { return (count_ + 7) / 8; }
+    };
+
+    class bit_reader {
+        std::byte const* data_;
+        size_t size_;
+        size_t position_ = 0;
+    public:
+        explicit bit_reader(span<std::byte const> data) noexcept :
+            data_{ data.data() },
+            size_{ data.size() }
+        {}
+
+        // Returns at least the next 57 bits, zeros past the end of the data.
+        uint64_t peek() const noexcept {
+            auto const index = position_ / 8;
+            uint64_t bits = 0;
+            if (index + 8 <= size_) {
+                for (size_t i = 0; i < 8; ++i) bits |= static_cast<uint64_t>(data_[index + i]) << (8 * i);
+            }
+            else {
+                for (size_t i = index; i < size_; ++i) bits |= static_cast<uint64_t>(data_[i]) << (8 * (i - index));
+            }
+            return bits >> (position_ % 8);
+        }
+        // Fails if the data holds less than count bits.
+        bool skip(size_t count) noexcept {
+            if (count > size_ * 8 - position_) return false;
+            position_ += count;
+            return true;
+        }
+        // Fails if the data holds less than count bits, with count <= 64.
+        bool read(uint64_t& value, unsigned count) noexcept {
+            if (count > 56) {
+                uint64_t high;
+                if (!read(value, 32) || !read(high, count - 32)) return false;
+                value |= high << 32;
+                return true;
+            }
+            value = peek() & ((uint64_t{ 1 } << count) - 1);
+            return skip(count);
+        }
+        // True when all the bytes were read.
+        bool is_finished() const noexcept {
+            return (position_ + 7) / 8 == size_;
+        }
+    };
+
+    template <class T, class Writer>
+    void encode(T const* values, size_t count, Writer& writer) noexcept {
+        using U = word_t<T>;
+        constexpr auto bits = word_bits<U>;
+        if (count == 0) return;
+
+        U previous;
+        memcpy(&previous, values, sizeof(U));
+        writer.write(previous, bits);
+
+        auto leading = bits, trailing = 0u;
+        for (size_t i = 1; i < count; ++i) {
+            U word;
+            memcpy(&word, values + i, sizeof(U));
+            auto const x = word ^ previous;
+            previous = word;
+
+            if (x == 0) {
+                writer.write(0, 1);
+                continue;
+            }
+            auto const l = count_leading_zeros(x, bits);
+            auto const t = count_trailing_zeros(x);
+            if (leading <= l && trailing <= t) {
+                writer.write(0b01, 2);
+                writer.write(x >> trailing, bits - leading - trailing);
+            }
+            else {
+                leading  = l;
+                trailing = t;
+                writer.write(0b11, 2);
+                writer.write(leading, count_bits<U>);
+                writer.write(bits - leading - trailing - 1, count_bits<U>);
+                writer.write(x >> trailing, bits - leading - trailing);
+            }
+        }
+    }
+
+    // Values are not written when null.
+    template <class T>
+    bool decode(T* values, size_t count, span<std::byte const> data) noexcept {
+        using U = word_t<T>;
+        constexpr auto bits = word_bits<U>;
+        auto reader = bit_reader{ data };
+        if (count == 0) return data.size() == 0;
+
+        uint64_t previous;
+        if (!reader.read(previous, bits)) return false;
+        if (values) memcpy(values, &previous, sizeof(U));
+
+        auto leading = bits, trailing = 0u;
+        for (size_t i = 1; i < count; ++i) {
+            auto const control = reader.peek();
+            if ((control & 1) != 0) {
+                if ((control & 2) != 0) {
+                    constexpr auto mask = (1u << count_bits<U>) - 1;
+                    auto const l      = static_cast<unsigned>(control >> 2) & mask;
+                    auto const length = static_cast<unsigned>(control >> (2 + count_bits<U>)) & mask;
+                    if (l + length + 1 > bits) return false;
+                    leading  = l;
+                    trailing = bits - l - length - 1;
+                    if (!reader.skip(2 + 2 * count_bits<U>)) return false;
+                }
+                else {
+                    if (leading == bits || !reader.skip(2)) return false;
+                }
+                uint64_t x;
+                if (!reader.read(x, bits - leading - trailing)) return false;
+                previous ^= x << trailing;
+            }
+            else if (!reader.skip(1)) {
+                return false;
+            }
+            if (values) {
+                auto const word = static_cast<U>(previous);
+                memcpy(values + i, &word, sizeof(U));
+            }
+        }
+        return reader.is_finished();
+    }
+}
+
+struct xor_codec {
+    template <class T>
+    static void check_type() noexcept {
+        static_assert(std::is_floating_point_v<T> && (sizeof(T) == 4 || sizeof(T) == 8),
+            "The xor codec only encodes floats and doubles");
+    }
+
+    // Each value takes at least one bit.
+    static constexpr bool is_possible_count(size_t count, size_t size) noexcept {
+        return count / 8 <= size;
+    }
+
+    template <class T>
+    static size_t get_encoded_size(T const* values, size_t count) noexcept {
+        check_type<T>();
+        auto counter = detail::xor_bits::bit_counter{};
+        detail::xor_bits::encode(values, count, counter);
+        return counter.size();
+    }
+
+    // Writes get_encoded_size(values, count) bytes.
+    template <class T>
+    static void encode(T const* values, size_t count, std::byte* data) noexcept {
+        check_type<T>();
+        auto writer = detail::xor_bits::bit_writer{ data };
+        detail::xor_bits::encode(values, count, writer);
+        writer.finish();
+    }
+
+    // Fails if the data doesn't hold exactly count values.
+    template <class T>
+    static bool decode(T* values, size_t count, span<std::byte const> data) noexcept {
+        check_type<T>();
+        return detail::xor_bits::decode(values, count, data);
+    }
+
+    template <class T>
+    static bool validate(size_t count, span<std::byte const> data) noexcept {
+        check_type<T>();
+        return detail::xor_bits::decode(static_cast<T*>(nullptr), count, data);
+    }
+};
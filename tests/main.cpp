@@ -1,34 +1,51 @@
 
 #include <binary_stream.hpp>
+#include <parallel_serialization.hpp>
+#include <mapped_archive.hpp>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <list>
 #include <map>
+#include <set>
+#include <optional>
+#include <variant>
 
 auto buffer = std::array<std::byte, 1000>{};
 
-template <class T>
+template <class Format = native_format, class T>
 void test(T const& value, serialization_category category, size_t serial_size) {
     assert(serialization_category_v<T> == category);
 
-    auto ostream = binary_ostream{ buffer };
+    auto ostream = basic_binary_ostream<fail_flag_serialization_policy, Format>{ buffer };
     ostream << value;
     assert(!ostream.overflow);
 
     size_t const size = ostream.data() - buffer.data();
-    assert(size == get_serialized_size(value));
+    assert(size == get_serialized_size<Format>(value));
     assert(size == serial_size);
 
     auto value_copy = T{};
-    auto istream = binary_istream{ buffer };
+    auto istream = basic_binary_istream<fail_flag_serialization_policy, Format>{ buffer };
     istream >> value_copy;
 
     assert(ostream.data() == istream.data());
     assert(value == value_copy);
 
+    istream = { buffer.data(), serial_size };
+    istream >> value_copy;
+    assert(value == value_copy);
+
+    istream = { buffer.data(), serial_size - 1 };
+    istream >> value_copy;
+    assert(istream.overflow);
+    assert(istream.data() == buffer.data());
+    assert(value == value_copy);
+
     ostream = { buffer.data(), serial_size - 1 };
     ostream << value;
     assert(ostream.overflow);
+    assert(ostream.data() == buffer.data());
 }
 
 struct vec2i {
@@ -48,6 +65,64 @@ struct person {
     }
 };
 
+struct padded {
+    char tag;
+    double value;
+    char flags;
+
+    bool operator==(padded const& rhs) const noexcept {
+        return as_tuple(*this) == as_tuple(rhs);
+    }
+};
+
+struct padded_pair {
+    padded first;
+    char a, b;
+    int count;
+
+    bool operator==(padded_pair const& rhs) const noexcept {
+        return as_tuple(*this) == as_tuple(rhs);
+    }
+};
+
+struct employee {
+    std::string name;
+    int age;
+    int height;
+    double salary;
+    std::string team;
+
+    bool operator==(employee const& rhs) const noexcept {
+        return as_tuple(*this) == as_tuple(rhs);
+    }
+};
+
+struct reading {
+    std::string sensor;
+    int64_t time;
+    double value;
+
+    bool operator==(reading const& rhs) const noexcept {
+        return as_tuple(*this) == as_tuple(rhs);
+    }
+};
+template <>
+constexpr bool is_columnar_v<reading> = true;
+
+template <>
+struct array_codec<std::vector<int64_t>> {
+    using type = delta_codec;
+};
+template <>
+struct array_codec<std::vector<double>> {
+    using type = xor_codec;
+};
+
+struct person_view {
+    std::string_view name;
+    int age;
+};
+
 struct family {
     std::pair<person, person> parents;
     std::vector<person> childs;
@@ -58,12 +133,1017 @@ struct family {
     }
 };
 
+template <class T>
+void test_chunked(T const& value) {
+    auto pool = chunk_pool{ 16 };
+    auto ostream = chunked_ostream{ pool };
+    ostream << value << value;
+
+    auto expected = std::vector<std::byte>(2 * get_serialized_size(value));
+    auto expected_span = span<std::byte>{ expected };
+    serialize(value, expected_span);
+    serialize(value, expected_span);
+
+    assert(ostream.size() == expected.size());
+    assert(ostream.to_vector() == expected);
+
+    size_t chunks_size = 0;
+    for (auto chunk : ostream.chunks()) chunks_size += chunk.size();
+    assert(chunks_size == expected.size());
+}
+
+template <class Format = compact_format, class T>
+void test_buffer_sequence(T const& value) {
+    auto pool = chunk_pool{ 7 };
+    auto ostream = basic_chunked_ostream<Format>{ pool };
+    ostream << value << value;
+    auto const chunks = ostream.chunks();
+    assert(chunks.size() > 1);
+
+    auto first = T{}, second = T{};
+    auto istream = basic_buffer_sequence_istream<fail_flag_serialization_policy, Format>{ chunks };
+    istream >> first >> second;
+    assert(!istream.overflow);
+    assert(istream.size() == 0);
+    assert(first == value && second == value);
+
+    istream >> first;
+    assert(istream.overflow);
+}
+
+void test_views() {
+    static_assert(serialization_category_v<std::string_view> == serialization_category::view);
+    static_assert(serialization_category_v<person_view> == serialization_category::aggregate);
+
+    auto const lily = person{ "Lily", 24 };
+    auto const values = std::vector{ 1, 2, 3 };
+    auto storage = std::vector<std::byte>(get_serialized_size(values) + get_serialized_size(lily));
+    auto ostream = binary_ostream{ storage };
+    ostream << values << lily;
+
+    auto values_view = span<int const>{};
+    auto lily_view = person_view{};
+    auto istream = binary_istream{ storage };
+    istream >> values_view >> lily_view;
+    assert(!istream.overflow);
+
+    assert(values_view.data() == reinterpret_cast<int const*>(storage.data() + sizeof(size_t)));
+    assert(std::equal(values_view.begin(), values_view.end(), values.begin(), values.end()));
+    assert(lily_view.name == lily.name && lily_view.age == lily.age);
+    assert(lily_view.name.data() >= reinterpret_cast<char const*>(storage.data()));
+
+    auto misaligned = binary_istream{ storage.data() + 1, storage.size() - 1 };
+    misaligned >> values_view;
+    assert(misaligned.overflow);
+
+    test(std::string_view{ "Lily" }, serialization_category::view, sizeof(size_t) + 4);
+}
+
+void test_columns() {
+    auto const readings = std::vector<reading>{ { "a", 10, 0.5 }, { "bc", 20, 1.5 }, { "d", 30, 2.5 } };
+    auto const size = sizeof(size_t) + 3 * sizeof(size_t) + 4 + 3 * sizeof(int64_t) + 3 * sizeof(double);
+    test(readings, serialization_category::columnar_array, size);
+    test_buffer_sequence(readings);
+
+    auto out = span<std::byte>{ buffer };
+    serialize(readings, out);
+    assert(try_get_deserialized_size<std::vector<reading>>(buffer).first == size);
+
+    int64_t times[3];
+    memcpy(times, buffer.data() + sizeof(size_t) + 3 * sizeof(size_t) + 4, sizeof(times));
+    assert(times[0] == 10 && times[1] == 20 && times[2] == 30);
+}
+
+template <class T>
+void test_delta_codec(std::vector<T> const& values) {
+    auto encoded = std::vector<std::byte>(delta_codec::get_encoded_size(values.data(), values.size()));
+    delta_codec::encode(values.data(), values.size(), encoded.data());
+    assert(delta_codec::validate<T>(values.size(), encoded));
+
+    auto decoded = std::vector<T>(values.size());
+    assert(delta_codec::decode(decoded.data(), decoded.size(), encoded));
+    assert(decoded == values);
+
+    if (encoded.empty()) return;
+    assert(!delta_codec::validate<T>(values.size(), span<std::byte const>{ encoded.data(), encoded.size() - 1 }));
+    encoded[0] = std::byte{ 65 };
+    assert(!delta_codec::decode(decoded.data(), decoded.size(), encoded));
+}
+
+template <class T>
+std::vector<T> make_integers(size_t count, uint64_t step) {
+    auto values = std::vector<T>(count);
+    uint64_t x = 42;
+    for (auto& value : values) {
+        x = x * 6364136223846793005u + 1442695040888963407u;
+        value = static_cast<T>(x >> (64 - step));
+    }
+    return values;
+}
+
+void test_delta_codecs() {
+    for (size_t count : { 0, 1, 127, 128, 300 }) {
+        for (uint64_t step : { 1, 7, 31, 64 }) {
+            test_delta_codec(make_integers<int8_t>(count, step));
+            test_delta_codec(make_integers<uint16_t>(count, step));
+            test_delta_codec(make_integers<int32_t>(count, step));
+            test_delta_codec(make_integers<uint32_t>(count, step));
+            test_delta_codec(make_integers<int64_t>(count, step));
+            test_delta_codec(make_integers<uint64_t>(count, step));
+        }
+    }
+
+    auto times = std::vector<int64_t>(300);
+    for (size_t i = 0; i < times.size(); ++i) times[i] = 1000 * static_cast<int64_t>(i) - static_cast<int64_t>(i % 7);
+    auto const size = 2 * sizeof(size_t) + 2 * (1 + 16 * 11) + 1 + (44 * 11 + 7) / 8;
+    test(times, serialization_category::encoded_array, size);
+    test_buffer_sequence(times);
+    test_chunked(times);
+
+    auto out = span<std::byte>{ buffer };
+    serialize(times, out);
+    assert(try_get_deserialized_size<std::vector<int64_t>>(buffer).first == size);
+    buffer[2 * sizeof(size_t)] = std::byte{ 65 };
+    assert(!try_get_deserialized_size<std::vector<int64_t>>(buffer).second);
+    auto source = span<std::byte const>{ buffer };
+    auto times_copy = std::vector<int64_t>{};
+    assert(!try_deserialize(times_copy, source));
+}
+
+template <class T>
+void test_xor_codec(std::vector<T> const& values) {
+    auto encoded = std::vector<std::byte>(xor_codec::get_encoded_size(values.data(), values.size()));
+    xor_codec::encode(values.data(), values.size(), encoded.data());
+    assert(xor_codec::validate<T>(values.size(), encoded));
+
+    auto decoded = std::vector<T>(values.size());
+    assert(xor_codec::decode(decoded.data(), decoded.size(), encoded));
+    assert(values.empty() || memcmp(decoded.data(), values.data(), values.size() * sizeof(T)) == 0);
+
+    if (encoded.empty()) return;
+    assert(!xor_codec::validate<T>(values.size(), span<std::byte const>{ encoded.data(), encoded.size() - 1 }));
+}
+
+void test_xor_codecs() {
+    auto const specials = std::vector<double>{ 0.0, -0.0, 1.0, 1e308, -1e-308, 4.9e-324, 1.0, 1.0, 2.0 };
+    test_xor_codec(specials);
+    test_xor_codec(std::vector<double>{});
+    test_xor_codec(std::vector<float>{ 1.5f, 1.5f, -3.25f, 1e38f, 0.1f });
+
+    auto noisy = std::vector<double>(100);
+    uint64_t x = 42;
+    for (auto& value : noisy) {
+        x = x * 6364136223846793005u + 1442695040888963407u;
+        memcpy(&value, &x, sizeof(x));
+        if (value != value) value = 0.0;
+    }
+    test_xor_codec(noisy);
+
+    auto series = std::vector<double>(60);
+    for (size_t i = 0; i < series.size(); ++i) series[i] = 20.0 + static_cast<double>(i % 4) * 0.25;
+    auto const size = get_serialized_size(series);
+    assert(size < 2 * sizeof(size_t) + series.size() * sizeof(double) / 3);
+    test(series, serialization_category::encoded_array, size);
+    test_buffer_sequence(series);
+
+    auto out = span<std::byte>{ buffer };
+    serialize(series, out);
+    assert(try_get_deserialized_size<std::vector<double>>(buffer).first == size);
+    auto const truncated = span<std::byte const>{ buffer.data(), size - 1 };
+    assert(!try_get_deserialized_size<std::vector<double>>(truncated).second);
+}
+
+void test_lz_compression() {
+    uint64_t x = 42;
+    auto input = std::vector<std::byte>(5000);
+    for (size_t i = 0; i < input.size(); ++i) {
+        x = x * 6364136223846793005u + 1442695040888963407u;
+        input[i] = static_cast<std::byte>(i < 2000 ? (x >> 60) : i % 7 == 0 ? (x >> 56) : 'a');
+    }
+    for (size_t size : { 0, 1, 4, 13, 100, 2000, 5000 }) {
+        auto compressed = std::vector<std::byte>(lz_compress_bound(size));
+        compressed.resize(lz_compress({ input.data(), size }, compressed.data()));
+        auto output = std::vector<std::byte>(size);
+        assert(lz_decompress(compressed, output));
+        assert(std::equal(output.begin(), output.end(), input.begin()));
+
+        if (size == 0) continue;
+        output.push_back({});
+        assert(!lz_decompress(compressed, output));
+        output.resize(size - 1);
+        assert(!lz_decompress(compressed, output));
+    }
+
+    // Blocks end with 5 literals, and the last 12 bytes don't start a match, as in LZ4.
+    auto const repeated = std::vector<std::byte>(64, std::byte{ 'a' });
+    auto compressed = std::vector<std::byte>(lz_compress_bound(repeated.size()));
+    compressed.resize(lz_compress(repeated, compressed.data()));
+    assert(compressed.size() == 1 + 1 + 2 + 1 + 1 + 5);
+    assert(compressed[compressed.size() - 6] == std::byte{ 5 << 4 });
+    compressed.resize(lz_compress({ repeated.data(), 12 }, compressed.data()));
+    assert(compressed.size() == 1 + 12);
+}
+
+void test_compression() {
+    test_lz_compression();
+
+    auto const persons = std::vector<person>(100, person{ "Lily", 24 });
+    auto const text = std::string(1000, 'a');
+    auto pool = chunk_pool{};
+    auto compressed = chunked_buffer{ pool };
+    auto ostream = compressed_ostream<chunked_buffer>{ compressed, 256 };
+    ostream << persons << text;
+    ostream.flush();
+    assert(ostream.size() == get_serialized_size(persons) + get_serialized_size(text));
+    assert(compressed.size() < ostream.size() / 4);
+
+    auto const data = compressed.to_vector();
+    auto persons_copy = std::vector<person>{};
+    auto text_copy = std::string{};
+    auto istream = compressed_istream{ data };
+    istream >> persons_copy >> text_copy;
+    assert(!istream.overflow && istream.size() == 0);
+    assert(persons_copy == persons && text_copy == text);
+    istream >> text_copy;
+    assert(istream.overflow);
+
+    // A failed read rolls back to a previous block.
+    auto pair = std::pair<std::string, int>{};
+    istream = compressed_istream{ data };
+    istream >> persons_copy;
+    assert(!try_deserialize(pair, istream));
+    istream >> text_copy;
+    assert(!istream.overflow && text_copy == text);
+
+    auto blocks = std::vector<compressed_block>{};
+    assert(get_compressed_blocks(data, blocks));
+    assert(blocks.size() == (ostream.size() + 255) / 256);
+    auto plain = std::vector<std::byte>(ostream.size());
+    auto plain_out = span<std::byte>{ plain };
+    serialize(persons, plain_out);
+    serialize(text, plain_out);
+    for (auto& block : blocks) {
+        auto decompressed = std::vector<std::byte>(block.size);
+        assert(decompress_block(block, decompressed.data()));
+        assert(std::equal(decompressed.begin(), decompressed.end(), plain.begin() + block.offset));
+    }
+
+    auto truncated = compressed_istream{ span<std::byte const>{ data.data(), data.size() - 1 } };
+    truncated >> persons_copy >> text_copy;
+    assert(truncated.overflow);
+
+    auto corrupted_data = data;
+    corrupted_data[sizeof(uint32_t)] = std::byte{ 0xFF };
+    auto corrupted = compressed_istream{ corrupted_data };
+    corrupted >> persons_copy;
+    assert(corrupted.overflow && corrupted.corrupted());
+
+    // A block corrupted in the middle of a read fails it.
+    auto ints = chunked_buffer{ pool };
+    auto ints_ostream = compressed_ostream<chunked_buffer>{ ints, 256 };
+    auto const values = std::vector<int>(1000, 7);
+    ints_ostream << values;
+    ints_ostream.flush();
+    auto ints_data = ints.to_vector();
+    auto ints_blocks = std::vector<compressed_block>{};
+    assert(get_compressed_blocks(ints_data, ints_blocks) && ints_blocks.size() > 3);
+    auto const size_field = ints_blocks[2].data.data() - sizeof(uint32_t) - ints_data.data();
+    ints_data[size_field] = std::byte{ static_cast<unsigned char>(static_cast<unsigned char>(ints_data[size_field]) + 1) };
+    auto values_copy = std::vector<int>{};
+    auto ints_reader = decompressing_reader{ ints_data };
+    auto const ints_size = ints_reader.size();
+    assert(!try_deserialize(values_copy, ints_reader) && ints_reader.size() == ints_size);
+    deserialize(values_copy, ints_reader);
+    assert(ints_reader.corrupted());
+    auto ints_istream = compressed_istream{ ints_data };
+    ints_istream >> values_copy;
+    assert(ints_istream.overflow);
+
+    // Encoded arrays are read out of the source before being decoded. Their bytes are zeros
+    // but the first ones, so the bytes zeroed from a corrupted block would decode.
+    auto deltas = chunked_buffer{ pool };
+    auto deltas_ostream = compressed_ostream<chunked_buffer>{ deltas, 256 };
+    auto deltas_values = std::vector<int64_t>(128 * 1000);
+    deltas_values.front() = 42;
+    deltas_ostream << deltas_values;
+    deltas_ostream.flush();
+    auto deltas_data = deltas.to_vector();
+    auto deltas_copy = std::vector<int64_t>{};
+    auto deltas_reader = decompressing_reader{ deltas_data };
+    assert(try_deserialize(deltas_copy, deltas_reader) && deltas_copy == deltas_values);
+    auto deltas_blocks = std::vector<compressed_block>{};
+    assert(get_compressed_blocks(deltas_data, deltas_blocks) && deltas_blocks.size() > 3);
+    auto const last_field = deltas_blocks[deltas_blocks.size() - 2].data.data() - sizeof(uint32_t) - deltas_data.data();
+    deltas_data[last_field] = std::byte{ static_cast<unsigned char>(static_cast<unsigned char>(deltas_data[last_field]) + 1) };
+    deltas_copy.clear();
+    deltas_reader = decompressing_reader{ deltas_data };
+    assert(!try_deserialize(deltas_copy, deltas_reader) && deltas_copy.empty());
+
+    auto span_ostream = binary_ostream{ buffer };
+    auto small_ostream = compressed_ostream<binary_ostream>{ span_ostream };
+    small_ostream << text;
+    small_ostream.flush();
+    assert(!small_ostream.overflow() && span_ostream.data() < buffer.data() + 100);
+    auto noise = std::vector<uint32_t>(300);
+    for (size_t i = 0; i < noise.size(); ++i) noise[i] = static_cast<uint32_t>(i * 2654435761u);
+    small_ostream << noise;
+    small_ostream.flush();
+    assert(small_ostream.overflow());
+}
+
+void test_interning() {
+    using record = std::map<std::string, int>;
+    auto const records = std::vector<record>(20, { { "timestamp", 1 }, { "severity", 2 }, { "source", 3 } });
+    auto ostream = interning_ostream{ buffer };
+    ostream << records << std::string{ "severity" };
+    assert(!ostream.overflow && ostream.strings().size() == 3);
+
+    size_t const size = ostream.data() - buffer.data();
+    assert(size < get_serialized_size<interned_format>(records) / 2);
+    assert((try_get_deserialized_size<std::vector<record>, interned_format>(buffer).first == size - 1));
+
+    auto records_copy = std::vector<record>{};
+    auto severity = std::string_view{};
+    auto istream = interning_istream{ buffer.data(), size };
+    istream >> records_copy >> severity;
+    assert(!istream.overflow && istream.size() == 0);
+    assert(records_copy == records && severity == "severity");
+    assert(severity.data() > reinterpret_cast<char const*>(buffer.data()));
+    assert(severity.data() < reinterpret_cast<char const*>(buffer.data()) + size);
+
+    auto truncated = interning_istream{ buffer.data(), size - 2 };
+    assert(!try_deserialize<interned_format>(records_copy, truncated));
+    assert(truncated.strings().size() == 0);
+
+    auto small = interning_ostream{ buffer.data(), 20 };
+    small << std::pair{ std::string{ "first" }, std::string(30, 'x') };
+    assert(small.overflow && small.strings().size() == 0);
+}
+
+struct entity_id {
+    int value;
+    explicit entity_id(int value) noexcept : value{ value } {}
+    bool operator<(entity_id rhs)  const noexcept { return value <  rhs.value; }
+    bool operator==(entity_id rhs) const noexcept { return value == rhs.value; }
+};
+
+struct entity {
+    entity_id id;
+    std::string name;
+
+    bool operator==(entity const& rhs) const noexcept {
+        return id == rhs.id && name == rhs.name;
+    }
+};
+
+void test_in_place_construction() {
+    static_assert(!std::is_default_constructible_v<entity>);
+
+    auto const entities = std::map<entity_id, entity>{
+        { entity_id{ 1 }, { entity_id{ 1 }, "Lily" } },
+        { entity_id{ 2 }, { entity_id{ 2 }, "Alice" } }
+    };
+    auto ostream = binary_ostream{ buffer };
+    ostream << entities << std::pair{ 3, std::string{ "Bob" } };
+
+    auto source = span<std::byte const>{ buffer };
+    assert((deserialize<std::map<entity_id, entity>>(source) == entities));
+    assert((deserialize<std::pair<int const, std::string>>(source) == std::pair<int const, std::string>{ 3, "Bob" }));
+    assert(source.data() == ostream.data());
+
+    auto truncated = span<std::byte const>{ buffer.data(), get_serialized_size(entities) - 1 };
+    auto entities_copy = std::map<entity_id, entity>{};
+    assert(!try_deserialize(entities_copy, truncated));
+}
+
+struct profile {
+    std::optional<std::string> nickname;
+    std::optional<int> age;
+    std::variant<int, std::string> contact;
+
+    bool operator==(profile const& rhs) const noexcept {
+        return as_tuple(*this) == as_tuple(rhs);
+    }
+};
+
+struct sparse_reading {
+    int id;
+    std::optional<float> value;
+
+    bool operator==(sparse_reading const& rhs) const noexcept {
+        return as_tuple(*this) == as_tuple(rhs);
+    }
+};
+
+void test_tagged_unions() {
+    using optional_int = std::optional<int>;
+    using contact = std::variant<int, std::string, vec2i>;
+    test(optional_int{}, serialization_category::optional, 1);
+    test(optional_int{ 42 }, serialization_category::optional, 1 + sizeof(int));
+    test(std::optional<std::string>{ "Lily" }, serialization_category::optional, 1 + sizeof(size_t) + 4);
+    test(std::optional<entity_id>{ entity_id{ 7 } }, serialization_category::optional, 1 + sizeof(int));
+    test(contact{ std::string{ "Lily" } }, serialization_category::variant, 1 + sizeof(size_t) + 4);
+    test(contact{ vec2i{ 3, 4 } }, serialization_category::variant, 1 + sizeof(vec2i));
+    test(std::vector<optional_int>{ 1, {}, 3 }, serialization_category::dynamic_array, sizeof(size_t) + 3 + 2 * sizeof(int));
+    test(profile{ {}, 30, 5 }, serialization_category::aggregate, 1 + 1 + sizeof(int) + 1 + sizeof(int));
+    test(profile{ "Lil", {}, std::string{ "Alice" } }, serialization_category::aggregate,
+        1 + sizeof(size_t) + 3 + 1 + 1 + sizeof(size_t) + 5);
+
+    static_assert(std::is_trivially_copyable_v<sparse_reading>);
+    test(sparse_reading{ 1, {} }, serialization_category::aggregate, sizeof(int) + 1);
+    test(std::vector<sparse_reading>{ { 1, {} }, { 2, 0.5f } }, serialization_category::dynamic_array,
+        sizeof(size_t) + 2 * (sizeof(int) + 1) + sizeof(float));
+
+    static_assert(detail::get_min_serialized_size<contact, native_format>() == 1 + sizeof(int));
+    static_assert(has_static_serialized_size_v<std::variant<int, float>>);
+    static_assert(serialized_size_v<std::variant<int, float>> == 1 + sizeof(int));
+
+    // Discriminants out of range are rejected, and unchecked reads reuse the alternative storage.
+    auto value = contact{ std::string(100, 'x') };
+    auto const name = std::string(40, 'b');
+    auto ostream = binary_ostream{ buffer };
+    ostream << contact{ name };
+    auto in = span<std::byte const>{ buffer };
+    auto const capacity = std::get<std::string>(value).capacity();
+    deserialize(value, in);
+    assert(std::get<std::string>(value) == name && std::get<std::string>(value).capacity() == capacity);
+
+    ostream = binary_ostream{ buffer };
+    ostream << contact{ std::string{ "Bob" } };
+    buffer[0] = std::byte{ 3 };
+    auto source = span<std::byte const>{ buffer.data(), 1 + sizeof(size_t) + 3 };
+    assert(!try_deserialize(value, source));
+    assert(!try_get_deserialized_size<contact>(source).second);
+    buffer[0] = std::byte{ 2 };
+    auto ints = std::variant<int, float>{};
+    assert(!try_deserialize(ints, source));
+    auto flag = optional_int{};
+    assert(!try_deserialize(flag, source));
+}
+
+enum class heading : uint8_t { north, east, south, west };
+enum class stance  : uint8_t { idle, walking, running };
+
+template <>
+struct value_range<heading> {
+    static constexpr auto min = heading::north;
+    static constexpr auto max = heading::west;
+};
+template <>
+struct value_range<stance> {
+    static constexpr auto min = stance::idle;
+    static constexpr auto max = stance::running;
+};
+
+struct player_state {
+    packed_bool alive;
+    packed_bool crouching;
+    heading facing;
+    stance moving;
+    ranged<int, -10, 10> speed;
+    uint32_t score;
+    std::string name;
+
+    bool operator==(player_state const& rhs) const noexcept {
+        return as_tuple(*this) == as_tuple(rhs);
+    }
+};
+
+struct unit_update {
+    uint32_t id;
+    uint32_t tick;
+    packed_bool visible;
+    heading facing;
+    stance moving;
+
+    bool operator==(unit_update const& rhs) const noexcept {
+        return as_tuple(*this) == as_tuple(rhs);
+    }
+};
+
+struct tagged_entity {
+    entity_id id;
+    heading facing;
+    stance moving;
+};
+
+void test_bit_packing() {
+    test(heading::west, serialization_category::bit_packed, 1);
+    test(ranged<int, -10, 10>{ -10 }, serialization_category::bit_packed, 1);
+    test(std::pair{ heading::south, stance::running }, serialization_category::tuple, 1);
+    test(player_state{ true, false, heading::east, stance::walking, -3, 1200, "Lily" },
+        serialization_category::aggregate, 2 + sizeof(uint32_t) + sizeof(size_t) + 4);
+    test(unit_update{ 7, 42, true, heading::west, stance::running }, serialization_category::aggregate, 9);
+    static_assert(serialized_size_v<unit_update> == 9);
+    test(std::map<heading, stance>{ { heading::north, stance::idle }, { heading::west, stance::running } },
+        serialization_category::container, sizeof(size_t) + 2);
+
+    // Runs wider than a word continue in the next one.
+    using byte_field = ranged<uint8_t, 0, 255>;
+    test(std::tuple<byte_field, byte_field, byte_field, byte_field, byte_field, byte_field, byte_field, byte_field, byte_field>{
+        1, 2, 3, 4, 5, 6, 7, 8, 9 }, serialization_category::tuple, 9);
+    test(std::tuple<ranged<uint64_t, 0, UINT64_MAX>, packed_bool, int>{ UINT64_MAX - 1, true, 5 },
+        serialization_category::tuple, 9 + sizeof(int));
+
+    // Patterns out of the range are rejected.
+    buffer[0] = std::byte{ 3 };
+    auto source = span<std::byte const>{ buffer.data(), 1 };
+    auto moving = stance{};
+    assert(!try_deserialize(moving, source));
+    assert(source.size() == 1);
+    assert(!try_get_deserialized_size<stance>(source).second);
+    buffer[0] = std::byte{ 2 };
+    assert(try_deserialize(moving, source) && moving == stance::running);
+
+    auto const update = unit_update{ 1, 2, false, heading::north, stance::walking };
+    auto ostream = binary_ostream{ buffer };
+    ostream << update;
+    buffer[8] = std::byte{ 0b11000 };
+    auto update_copy = unit_update{};
+    source = { buffer.data(), 9 };
+    assert(!try_deserialize(update_copy, source));
+    assert(!try_get_deserialized_size<unit_update>(source).second);
+
+    // In place construction reads the bit runs once.
+    auto const entities = std::list<tagged_entity>{
+        { entity_id{ 1 }, heading::east, stance::idle }, { entity_id{ 2 }, heading::south, stance::running } };
+    ostream = binary_ostream{ buffer };
+    ostream << entities;
+    assert(get_serialized_size(entities) == sizeof(size_t) + 2 * (sizeof(int) + 1));
+    source = { buffer.data(), get_serialized_size(entities) };
+    auto const entities_copy = deserialize<std::list<tagged_entity>>(source);
+    assert(source.size() == 0 && entities_copy.size() == 2);
+    auto const& last = entities_copy.back();
+    assert(last.id == entity_id{ 2 } && last.facing == heading::south && last.moving == stance::running);
+}
+
+// Big endian is foreign to most hosts, which reverse the bytes of its scalars.
+struct big_endian_format : portable_format {
+    static constexpr auto endianness = byte_order::big;
+};
+
+template <class Format>
+void test_byte_order(serialization_category category) {
+    auto const p = padded{ 'a', 1.5, 'b' };
+    test<Format>(0x01020304, serialization_category::trivial, 4);
+    test<Format>(std::vector{ 1, 2, 3 }, category, 8 + 3 * sizeof(int));
+    test<Format>(std::vector<uint16_t>(37, 0x0102), category, 8 + 37 * 2);
+    test<Format>(std::vector{ 0.5, -1e300, 3.25, 7.0, 1e-10 }, serialization_category::encoded_array,
+                 get_serialized_size<Format>(std::vector{ 0.5, -1e300, 3.25, 7.0, 1e-10 }));
+    test<Format>(std::vector<float>{ 0.5f, -1e30f, 3.25f, 7.f, 1e-10f, 2.f, 9.f, 1.f, 4.f }, category, 8 + 9 * sizeof(float));
+    test<Format>(padded_pair{ p, 'c', 'd', 42 }, serialization_category::trivial, 16);
+    test<Format>(std::array{ p, p }, serialization_category::trivial, 20);
+    test<Format>(std::vector{ p, p, p }, category, 8 + 30);
+    test<Format>(employee{ "Lily", 24, 170, 2500.5, "R&D" }, serialization_category::aggregate, 2 * 8 + 4 + 3 + 2 * sizeof(int) + sizeof(double));
+    test<Format>(std::map<int, std::string>{ { 1, "one" }, { 300, "three hundred" } }, serialization_category::container,
+                 8 + 2 * (sizeof(int) + 8) + 3 + 13);
+    test<Format>(std::variant<int, std::string, vec2i>{ vec2i{ 3, 4 } }, serialization_category::variant, 1 + sizeof(vec2i));
+    test_buffer_sequence<Format>(std::vector<uint32_t>(100, 0x01020304));
+}
+
+void test_byte_orders() {
+    test_byte_order<portable_format>(serialization_category::trivial_array);
+    test_byte_order<big_endian_format>(serialization_category::trivial_array);
+
+    auto const expect_bytes = [] (std::initializer_list<int> bytes) {
+        return std::equal(bytes.begin(), bytes.end(), buffer.begin(), [] (int lhs, std::byte rhs) {
+            return lhs == static_cast<int>(rhs);
+        });
+    };
+    auto out = span<std::byte>{ buffer };
+    serialize<big_endian_format>(std::pair{ std::vector<uint16_t>{ 0x0102 }, 0x03040506 }, out);
+    assert(expect_bytes({ 0, 0, 0, 0, 0, 0, 0, 1, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06 }));
+    out = span<std::byte>{ buffer };
+    serialize<portable_format>(std::pair{ std::vector<uint16_t>{ 0x0102 }, 0x03040506 }, out);
+    assert(expect_bytes({ 1, 0, 0, 0, 0, 0, 0, 0, 0x02, 0x01, 0x06, 0x05, 0x04, 0x03 }));
+
+    // Sizes which don't fit in size_t fail to read.
+    if constexpr (sizeof(size_t) < sizeof(uint64_t)) {
+        std::fill(buffer.begin(), buffer.begin() + 8, std::byte{ 0xFF });
+        auto source = span<std::byte const>{ buffer };
+        auto values = std::vector<char>{};
+        assert(!try_deserialize<portable_format>(values, source));
+    }
+}
+
+template <class Format = native_format, class T>
+void test_parallel_serialization(T const& value, thread_pool& pool) {
+    auto expected = std::vector<std::byte>(get_serialized_size<Format>(value));
+    auto expected_span = span<std::byte>{ expected };
+    serialize<Format>(value, expected_span);
+
+    auto data = std::vector<std::byte>(expected.size() + 1);
+    auto out = span<std::byte>{ data };
+    assert(parallel_serialize<Format>(value, out, pool));
+    assert(out.size() == 1 && std::equal(expected.begin(), expected.end(), data.begin()));
+
+    out = { data.data(), expected.size() - 1 };
+    assert(!parallel_serialize<Format>(value, out, pool));
+    assert(out.data() == data.data());
+}
+
+void test_parallel_serializations() {
+    auto pool = thread_pool{ 4 };
+    auto persons = std::vector<person>(5000);
+    auto names = std::list<std::string>{};
+    auto ages = std::map<int, std::string>{};
+    for (int i = 0; i < 5000; ++i) {
+        persons[i] = { std::string(i % 30, 'a'), i };
+        names.push_back(std::string(i % 7, 'b'));
+        ages.emplace(i, std::string(i % 11, 'c'));
+    }
+    test_parallel_serialization(persons, pool);
+    test_parallel_serialization<compact_format>(persons, pool);
+    test_parallel_serialization(names, pool);
+    test_parallel_serialization<portable_format>(ages, pool);
+    test_parallel_serialization(std::vector<vec2i>(1000, { 1, 2 }), pool);
+    test_parallel_serialization(std::vector<person>{ { "Lily", 24 } }, pool);
+    test_parallel_serialization(person{ "Lily", 24 }, pool);
+
+    auto inline_pool = thread_pool{ 1 };
+    test_parallel_serialization(persons, inline_pool);
+}
+
+struct compact_indexed_format : compact_format {
+    static constexpr auto ranges = range_index::blocks;
+};
+
+template <class Format, class T>
+void test_indexed_range(T const& value, thread_pool& pool) {
+    test_parallel_serialization<Format>(value, pool);
+
+    auto data = std::vector<std::byte>(get_serialized_size<Format>(value));
+    auto out = span<std::byte>{ data };
+    serialize<Format>(value, out);
+    assert(out.size() == 0);
+    assert((try_get_deserialized_size<T, Format>(data).first == data.size()));
+
+    auto in = span<std::byte const>{ data };
+    auto value_copy = T{};
+    assert(try_deserialize<Format>(value_copy, in) && in.size() == 0 && value_copy == value);
+
+    value_copy = T{};
+    in = { data.data(), data.size() };
+    assert(parallel_deserialize<Format>(value_copy, in, pool) && in.size() == 0 && value_copy == value);
+
+    in = { data.data(), data.size() - 1 };
+    assert(!parallel_deserialize<Format>(value_copy, in, pool) && in.data() == data.data());
+    assert(!try_deserialize<Format>(value_copy, in) && in.data() == data.data());
+}
+
+void test_range_indices() {
+    auto pool = thread_pool{ 4 };
+    auto persons = std::vector<person>(2500);
+    auto names = std::list<std::string>{};
+    for (int i = 0; i < 2500; ++i) {
+        persons[i] = { std::string(i % 30, 'a'), i };
+        names.push_back(std::string(i % 7, 'b'));
+    }
+    test_indexed_range<indexed_format>(persons, pool);
+    test_indexed_range<compact_indexed_format>(persons, pool);
+    test_indexed_range<indexed_format>(names, pool);
+    test_indexed_range<indexed_format>(std::vector<std::vector<person>>{ persons, {}, persons }, pool);
+
+    // Ranges of one block, and trivial arrays, have no index.
+    auto const small = std::vector<person>(persons.begin(), persons.begin() + range_index_stride);
+    assert(get_serialized_size<indexed_format>(small) == get_serialized_size(small));
+    assert(get_serialized_size<indexed_format>(std::vector<int>(5000)) == sizeof(size_t) + 5000 * sizeof(int));
+    // Count, size of the elements, then the sizes of the first two blocks.
+    assert(get_serialized_size<indexed_format>(persons) == get_serialized_size(persons) + 3 * sizeof(size_t));
+
+    // Blocks overflowing the elements fail.
+    auto data = std::vector<std::byte>(get_serialized_size<indexed_format>(persons));
+    auto out = span<std::byte>{ data };
+    serialize<indexed_format>(persons, out);
+    auto const block_size = data.end() - 2 * sizeof(size_t);
+    auto const corrupted = ~size_t{ 0 } / 2;
+    memcpy(&*block_size, &corrupted, sizeof(corrupted));
+    auto in = span<std::byte const>{ data };
+    auto persons_copy = std::vector<person>{};
+    assert(!parallel_deserialize<indexed_format>(persons_copy, in, pool));
+    assert(!try_deserialize<indexed_format>(persons_copy, in));
+    assert(!(try_get_deserialized_size<std::vector<person>, indexed_format>(data).second));
+
+    // A corrupted element fails its block, and leaves the array untouched.
+    serialize<indexed_format>(persons, out = span<std::byte>{ data });
+    auto const name_size = data.begin() + 2 * sizeof(size_t);
+    memcpy(&*name_size, &corrupted, sizeof(corrupted));
+    auto const kept = std::vector<person>{ { "keep", 1 } };
+    persons_copy = kept;
+    in = span<std::byte const>{ data };
+    assert(!parallel_deserialize<indexed_format>(persons_copy, in, pool) && in.data() == data.data());
+    assert(persons_copy == kept);
+}
+
+// Growable buffer of the values written with their tables.
+struct byte_vector {
+    std::vector<std::byte> bytes;
+
+    void write(void const* data, size_t size) {
+        auto const begin = static_cast<std::byte const*>(data);
+        bytes.insert(bytes.end(), begin, begin + size);
+    }
+};
+
+struct catalog {
+    std::string title;
+    std::vector<person> persons;
+    std::map<int, std::string> tags;
+    uint32_t version;
+    player_state owner;
+
+    bool operator==(catalog const& rhs) const noexcept {
+        return as_tuple(*this) == as_tuple(rhs);
+    }
+};
+
+template <class Format, class T>
+lazy_reader<T, Format> test_lazy_reader(T const& value, byte_vector& archive) {
+    archive.bytes.clear();
+    serialize_with_tables<Format>(value, archive);
+
+    // The value is written as serialize does.
+    auto data = std::vector<std::byte>(get_serialized_size<Format>(value));
+    auto out = span<std::byte>{ data };
+    serialize<Format>(value, out);
+    assert(archive.bytes.size() > data.size());
+    assert(std::equal(data.begin(), data.end(), archive.bytes.begin()));
+
+    auto const reader = lazy_reader<T, Format>{ archive.bytes };
+    auto value_copy = T{};
+    assert(reader.try_read(value_copy) && value_copy == value);
+    assert(reader.read() == value);
+    return reader;
+}
+
+template <class Format>
+void test_lazy_catalog() {
+    auto value = catalog{ "Staff", {}, { { 1, "red" }, { 7, "blue" } }, 3,
+        { true, false, heading::east, stance::walking, -3, 1200, "Lily" } };
+    for (int i = 0; i < 40; ++i) value.persons.push_back({ std::string(i % 9, 'a'), i });
+
+    auto archive = byte_vector{};
+    auto const reader = test_lazy_reader<Format>(value, archive);
+    assert(reader.template get<0>().read() == "Staff");
+    assert(reader.template get<3>().read() == 3);
+    assert(reader.template get<4>().template get<5>().read() == 1200);
+    assert(reader.template get<4>().template get<6>().read() == "Lily");
+
+    auto const persons = reader.template get<1>();
+    assert(persons.size() == 40);
+    for (size_t i = 0; i < 40; ++i) {
+        assert(persons[i].read() == value.persons[i]);
+        assert(persons[i].template get<1>().read() == static_cast<int>(i));
+    }
+    auto const tags = reader.template get<2>();
+    assert(tags.size() == 2 && tags[1].read().second == "blue");
+
+    // Elements out of the range fail to be read.
+    auto missing = person{};
+    assert(!persons[40].try_read(missing));
+}
+
+void test_lazy_readers() {
+    test_lazy_catalog<native_format>();
+    test_lazy_catalog<compact_format>();
+    test_lazy_catalog<big_endian_format>();
+
+    // Ranges of values of static size have no table.
+    auto archive = byte_vector{};
+    auto const positions = std::vector<vec2i>{ { 1, 2 }, { 3, 4 }, { 5, 6 } };
+    auto const positions_reader = test_lazy_reader<native_format>(positions, archive);
+    assert(archive.bytes.size() == get_serialized_size(positions) + sizeof(uint64_t));
+    assert(positions_reader[2].read() == (vec2i{ 5, 6 }));
+
+    auto persons = std::vector<person>(2500);
+    for (int i = 0; i < 2500; ++i) persons[i] = { std::string(i % 30, 'a'), i };
+    auto const persons_reader = test_lazy_reader<indexed_format>(persons, archive);
+    assert(persons_reader[2499].read() == persons[2499]);
+    assert(persons_reader[1234].get<0>().read() == persons[1234].name);
+
+    auto const teams = std::vector<std::vector<person>>{ { { "Lily", 24 } }, {}, { { "Ada", 36 }, { "Alan", 41 } } };
+    auto const teams_reader = test_lazy_reader<native_format>(teams, archive);
+    assert(teams_reader[2][1].read() == teams[2][1]);
+    assert(teams_reader[1].size() == 0);
+
+    // Offsets out of the value, and archives too small for the size of the value, fail.
+    test_lazy_reader<native_format>(persons, archive);
+    auto const serial_size = get_serialized_size(persons);
+    auto const corrupted = ~uint64_t{ 0 } / 2;
+    memcpy(archive.bytes.data() + serial_size + 5 * sizeof(uint64_t), &corrupted, sizeof(corrupted));
+    auto person_copy = person{};
+    auto const corrupted_reader = lazy_reader<std::vector<person>>{ archive.bytes };
+    assert(corrupted_reader[4].try_read(person_copy) && person_copy == persons[4]);
+    assert(!corrupted_reader[5].try_read(person_copy));
+
+    auto const truncated = span<std::byte const>{ archive.bytes.data(), 4 };
+    auto persons_copy = std::vector<person>{};
+    assert(!lazy_reader<std::vector<person>>{ truncated }.try_read(persons_copy));
+    assert(lazy_reader<std::vector<person>>{ truncated }.size() == 0);
+}
+
+void test_mapped_archive() {
+    auto const path = "test_archive.bin";
+    auto const persons = std::vector<person>{ { "Lily", 24 }, { "Ada", 36 } };
+    auto const ages = std::vector<int>{ 24, 36, 41 };
+    auto value = catalog{ "Staff", persons, { { 1, "red" } }, 3, {} };
+    {
+        auto writer = archive_writer{ path };
+        assert(writer.write(persons) == 0);
+        assert(writer.write<portable_format>(ages) == 1);
+        assert(writer.write(std::pair{ std::string{ "Lily" }, ages }) == 2);
+        assert(writer.write_with_tables(value) == 3);
+        assert(writer.write(std::string{}) == 4);
+        writer.close();
+    }
+    auto const archive = mapped_archive{ path };
+    assert(archive.size() == 5);
+    archive.prefetch(0, 2);
+
+    auto persons_copy = std::vector<person>{};
+    assert(archive.try_read(0, persons_copy) && persons_copy == persons);
+    auto ages_copy = std::vector<int>{};
+    assert(archive.try_read<portable_format>(1, ages_copy) && ages_copy == ages);
+    assert(archive.reader<catalog>(3).get<1>()[1].read() == persons[1]);
+    auto empty = std::string{ "Lily" };
+    assert(archive.try_read(4, empty) && empty.empty());
+
+    // Views alias the mapping.
+    auto views = std::pair<std::string_view, span<int const>>{};
+    auto const record = archive.record(2);
+    assert(archive.try_read(2, views) && views.first == "Lily" && views.second.size() == 3);
+    assert(views.second.data() > reinterpret_cast<int const*>(record.data()) && views.second.data()[2] == 41);
+
+    // Records out of the archive are empty.
+    assert(archive.record(5).size() == 0 && !archive.try_read(5, persons_copy));
+
+    // Archives which weren't closed, and missing files, fail to open.
+    {
+        auto writer = archive_writer{ path };
+        writer.write(persons);
+        auto failed = false;
+        try { mapped_archive{ path }; }
+        catch (std::runtime_error const&) { failed = true; }
+        assert(failed);
+    }
+    auto moved = mapped_archive{ path };
+    auto const archive_copy = std::move(moved);
+    assert(archive_copy.size() == 1 && moved.size() == 0);
+    std::remove(path);
+    auto failed = false;
+    try { mapped_archive{ path }; }
+    catch (std::system_error const&) { failed = true; }
+    assert(failed);
+}
+
+// Fields declared with alignas lie after the offsets computed from their types.
+struct over_aligned {
+    alignas(8) char a;
+    char b;
+    alignas(4) char c;
+
+    bool operator==(over_aligned const& rhs) const noexcept {
+        return as_tuple(*this) == as_tuple(rhs);
+    }
+};
+struct over_aligned_scalars {
+    alignas(8) char tag;
+    char flags;
+    alignas(4) uint16_t value;
+
+    bool operator==(over_aligned_scalars const& rhs) const noexcept {
+        return as_tuple(*this) == as_tuple(rhs);
+    }
+};
+
+struct over_aligned_record {
+    std::string name;
+    alignas(8) char a;
+    char b;
+    alignas(4) char c;
+
+    bool operator==(over_aligned_record const& rhs) const noexcept {
+        return as_tuple(*this) == as_tuple(rhs);
+    }
+};
+
+struct big_endian_native_format : native_format {
+    static constexpr auto endianness = byte_order::big;
+};
+
+void test_over_aligned_fields() {
+    auto const value = over_aligned{ 'A', 'B', 'C' };
+    test<packed_format>(value, serialization_category::trivial, 3);
+    test<packed_format>(std::array{ value, value }, serialization_category::trivial, 6);
+    auto bytes = std::array<std::byte, 3>{};
+    auto out = span<std::byte>{ bytes };
+    serialize<packed_format>(value, out);
+    assert(bytes[0] == std::byte{ 'A' } && bytes[1] == std::byte{ 'B' } && bytes[2] == std::byte{ 'C' });
+
+    auto const scalars = over_aligned_scalars{ 'T', 'F', 0x0102 };
+    test<big_endian_format>(scalars, serialization_category::trivial, 4);
+    test<big_endian_native_format>(scalars, serialization_category::trivial, sizeof(over_aligned_scalars));
+    auto scalars_bytes = std::array<std::byte, 4>{};
+    out = { scalars_bytes };
+    serialize<big_endian_format>(scalars, out);
+    assert(scalars_bytes[2] == std::byte{ 1 } && scalars_bytes[3] == std::byte{ 2 });
+
+    // Field runs copy the fields from their real offsets.
+    static_assert(detail::has_field_runs<over_aligned_record, native_format>());
+    test(over_aligned_record{ "Lily", 'A', 'B', 'C' }, serialization_category::aggregate, sizeof(size_t) + 4 + 3);
+}
+
+template <class T>
+void test_reuse(T const& value, T previous) {
+    auto ostream = binary_ostream{ buffer };
+    ostream << value;
+
+    auto istream = binary_istream{ buffer };
+    istream >> previous;
+    assert(!istream.overflow);
+    assert(previous == value);
+}
+
+void test_failed_reads() {
+    auto const values = std::vector<std::string>{ "first", "second" };
+    auto ostream = binary_ostream{ buffer };
+    ostream << values;
+    auto const size = get_serialized_size(values);
+
+    // Values are left untouched by the reads which fail, with every policy.
+    auto values_copy = std::vector<std::string>{ "keep" };
+    auto istream = binary_istream{ buffer.data(), size - 1 };
+    istream >> values_copy;
+    assert(istream.overflow && values_copy == std::vector<std::string>{ "keep" });
+
+    auto throwing = basic_binary_istream<throwing_serialization_policy>{ buffer.data(), size - 1 };
+    try {
+        throwing >> values_copy;
+        assert(false);
+    }
+    catch (std::runtime_error const&) {}
+    assert(values_copy == std::vector<std::string>{ "keep" });
+
+    auto in = span<std::byte const>{ buffer.data(), size - 1 };
+    assert(!try_deserialize(values_copy, in) && values_copy == std::vector<std::string>{ "keep" });
+}
+
+struct counting_less {
+    static inline size_t comparisons = 0;
+    bool operator()(int lhs, int rhs) const noexcept {
+        ++comparisons;
+        return lhs < rhs;
+    }
+};
+
+void test_ordered_insertion() {
+    auto value = std::map<int, int, counting_less>{};
+    for (int i = 0; i < 100; ++i) value.emplace(i, -i);
+
+    auto ostream = binary_ostream{ buffer };
+    ostream << value;
+
+    counting_less::comparisons = 0;
+    auto value_copy = std::map<int, int, counting_less>{};
+    auto istream = binary_istream{ buffer };
+    istream >> value_copy;
+    assert(value == value_copy);
+    assert(counting_less::comparisons <= 2 * value.size());
+}
+
+static_assert(serialized_size_v<vec2i> == sizeof(vec2i));
+static_assert(serialized_size_v<std::pair<vec2i, std::array<int, 3>>> == sizeof(vec2i) + 3 * sizeof(int));
+static_assert(!has_static_serialized_size_v<person>);
+static_assert(!has_max_serialized_size_v<std::vector<int>>);
+
+static_assert(serialized_size_v<padded, packed_format> == 10);
+static_assert(serialized_size_v<padded_pair, packed_format> == 16);
+static_assert(serialized_size_v<vec2i, packed_format> == sizeof(vec2i));
+static_assert(detail::copy_plan_v<padded_pair>.size() == 4); // tag, value, flags and a, b, count
+static_assert(detail::has_field_runs<employee, native_format>());
+static_assert(detail::field_steps_v<employee, native_format>.size() == 3); // name, age to salary, team
+static_assert(!detail::has_field_runs<person, native_format>());
+
+struct padded_with_array { char name[3]; double value; };
+struct padded_with_union { char tag; union { int i; float f; } value; };
+static_assert(serialized_size_v<padded_with_array, packed_format> == sizeof(padded_with_array));
+static_assert(serialized_size_v<padded_with_union, packed_format> == 1 + sizeof(int));
+
 int main() {
     test(vec2i{ 3, 4 },              serialization_category::trivial,       sizeof(vec2i));
     test(std::list{ 1, 2, 3 },       serialization_category::container,     sizeof(size_t) + 3 * sizeof(int));
     test(std::map<int, int>{{1, 2}}, serialization_category::container,     sizeof(size_t) + 2 * sizeof(int));
+    test(std::set{ 3, 1, 2 },        serialization_category::container,     sizeof(size_t) + 3 * sizeof(int));
     test(std::vector{ 1, 2, 3 },     serialization_category::trivial_array, sizeof(size_t) + 3 * sizeof(int));
     test(person{ "Lily", 24 },       serialization_category::aggregate,     sizeof(size_t) + 4 + sizeof(int));
+    test(std::pair{ vec2i{ 1, 2 }, std::array{ 3, 4 } }, serialization_category::tuple, 4 * sizeof(int));
+
+    auto const array = serialize_to_array(std::pair{ vec2i{ 1, 2 }, 3 });
+    static_assert(array.size() == 3 * sizeof(int));
+    auto pair = std::pair<vec2i, int>{};
+    auto array_buffer = span<std::byte const>{ array };
+    deserialize(pair, array_buffer);
+    assert(pair.first == (vec2i{ 1, 2 }) && pair.second == 3);
 
     auto f = family{};
     f.addresses.emplace("24 st. Monah", 128'0'0'1);
@@ -71,6 +1151,64 @@ int main() {
     f.parents.second = { "Bob",   28 };
     f.childs = { { "Chuckles", 4 }, { "David", 2 } };
     test(f, serialization_category::aggregate, get_serialized_size(f));
+
+    auto const e = employee{ "Lily", 24, 170, 2500.5, "R&D" };
+    test(e, serialization_category::aggregate, 2 * sizeof(size_t) + 4 + 3 + 2 * sizeof(int) + sizeof(double));
+    test_buffer_sequence(e);
+    auto e_buffer = span<std::byte>{ buffer };
+    serialize(e, e_buffer);
+    assert(try_get_deserialized_size<employee>(buffer).first == get_serialized_size(e));
+
+    test<compact_format>(std::vector{ 1, 2, 3 },       serialization_category::trivial_array, 1 + 3 * sizeof(int));
+    test<compact_format>(person{ "Lily", 24 },         serialization_category::aggregate,     1 + 4 + sizeof(int));
+    test<compact_format>(std::string(300, 'a'),        serialization_category::trivial_array, 2 + 300);
+    test<compact_format>(std::map<int, int>{{1, 2}},   serialization_category::container,     1 + 2 * sizeof(int));
+    test<compact_format>(f, serialization_category::aggregate, get_serialized_size<compact_format>(f));
+
+    auto const p = padded{ 'a', 1.5, 'b' };
+    test<packed_format>(p, serialization_category::trivial, 10);
+    test<packed_format>(padded_pair{ p, 'c', 'd', 42 }, serialization_category::trivial, 16);
+    test<packed_format>(std::array{ p, p }, serialization_category::trivial, 20);
+    test<packed_format>(std::vector{ p, p, p }, serialization_category::trivial_array, sizeof(size_t) + 30);
+    test<packed_format>(std::pair{ p, std::string{ "packed" } }, serialization_category::tuple, 10 + sizeof(size_t) + 6);
+    test_buffer_sequence<packed_format>(std::vector{ p, p, p });
+
+    test_chunked(f);
+    test_chunked(std::vector<int>(100, 42));
+
+    test_buffer_sequence(f);
+    test_buffer_sequence(std::vector<int>(100, 42));
+
+    test_views();
+    test_ordered_insertion();
+    test_failed_reads();
+    test_in_place_construction();
+    test_columns();
+    test_delta_codecs();
+    test_xor_codecs();
+    test_compression();
+    test_interning();
+    test_bit_packing();
+    test_tagged_unions();
+    test_byte_orders();
+    test_parallel_serializations();
+    test_range_indices();
+    test_lazy_readers();
+    test_mapped_archive();
+    test_over_aligned_fields();
+
+    test_reuse(std::map<int, int>{{1, 2}}, {{3, 4}, {5, 6}});
+    test_reuse(std::map<int, int>{{1, 2}, {3, 4}}, {{5, 6}});
+    test_reuse(std::list{ 1, 2 }, { 3, 4, 5 });
+    test_reuse(std::vector<person>{{ "Lily", 24 }}, {{ "Alice", 30 }, { "Bob", 28 }});
+
+    using const_pairs = std::vector<std::pair<int const, int>>;
+    auto pairs = const_pairs{};
+    auto pairs_buffer = span<std::byte>{ buffer };
+    serialize(const_pairs{{1, 2}, {3, 4}, {5, 6}}, pairs_buffer);
+    auto pairs_source = span<std::byte const>{ buffer };
+    deserialize(pairs, pairs_source);
+    assert(pairs.size() == 3 && pairs.capacity() == 3);
 }
 
 